@@ -5,6 +5,7 @@
 #include <benchmark/benchmark.h>
 
 #include <array>
+#include <sstream>
 
 // This part contains components structs that are going to be used for tests.
 // Different components are simply generated through meta-programming with use of component_generator class.
@@ -153,6 +154,178 @@ static void iterate_entities_with_system(benchmark::State& state) {
     state.SetBytesProcessed(int64_t(state.iterations()) * size * entities_count);
 }
 
+// Iterate N entities with 8 components reading the first and the last one, optionally after placing their columns
+// next to each other with the chunk layout pass
+template<std::size_t N, bool Optimize>
+static void iterate_co_accessed(benchmark::State& state) {
+    using components_tuple = typename components_generator<foo_creator<64>, 8>::type;
+    using first = foo<0, 64>;
+    using last = foo<7, 64>;
+
+    auto registry = co_ecs::registry();
+    for (std::size_t i = 0; i < N; i++) {
+        std::apply([&]<typename... Args>(Args&&... args) { registry.create<Args...>(std::forward<Args>(args)...); },
+            components_tuple{});
+    }
+
+    auto bench_func = [&]() {
+        registry.view<const first&, const last&>().each([](const first& a, const last& b) {
+            sum += static_cast<std::uint8_t>(a.data[0]) + static_cast<std::uint8_t>(b.data[0]);
+        });
+    };
+
+    if constexpr (Optimize) {
+        co_ecs::access_profile::enable(true);
+        bench_func();
+        co_ecs::access_profile::enable(false);
+        co_ecs::chunk_layout::optimize(registry);
+        co_ecs::access_profile::reset();
+    }
+
+    benchmark::DoNotOptimize(sum);
+
+    for (auto _ : state) {
+        bench_func();
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * (sizeof(first) + sizeof(last)) * N);
+}
+
+// Reads every component of N entities through type-erased visitation, per component per entity or per column
+template<std::size_t N, bool Columns>
+static void type_erased_traversal(benchmark::State& state) {
+    using components_tuple = typename components_generator<foo_creator<64>, 4>::type;
+
+    auto registry = co_ecs::registry();
+    for (std::size_t i = 0; i < N; i++) {
+        std::apply([&]<typename... Args>(Args&&... args) { registry.create<Args...>(std::forward<Args>(args)...); },
+            components_tuple{});
+    }
+    const auto& const_registry = registry;
+
+    benchmark::DoNotOptimize(sum);
+
+    for (auto _ : state) {
+        if constexpr (Columns) {
+            const_registry.visit_columns([](std::span<const co_ecs::entity>, co_ecs::const_component_column column) {
+                for (std::size_t i = 0; i < column.count; i++) {
+                    sum += *static_cast<const std::uint8_t*>(column.at(i));
+                }
+            });
+        } else {
+            const auto& archetypes = const_registry.archetypes();
+            for (std::size_t a = 0; a < archetypes.size(); a++) {
+                for (const auto& chunk : archetypes.by_index(a)->chunks()) {
+                    for (std::size_t i = 0; i < chunk.size(); i++) {
+                        chunk.visit(i, [](co_ecs::component_meta, const void* ptr) {
+                            sum += *static_cast<const std::uint8_t*>(ptr);
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(components_tuple) * N);
+}
+
+// Imports N entities with two components, from columnar data or by creating each entity from the same arrays
+template<std::size_t N, bool Columnar>
+static void columnar_import(benchmark::State& state) {
+    using first = foo<0, 64>;
+    using second = foo<1, 64>;
+
+    std::vector<first> firsts(N);
+    std::vector<second> seconds(N);
+    auto source = co_ecs::registry();
+    source.create_columns<first, second>(firsts, seconds);
+    std::stringstream file;
+    co_ecs::columnar::save<first, second>(source, file);
+    auto bytes = file.str();
+    auto data = std::as_bytes(std::span(bytes));
+
+    auto registry = co_ecs::registry();
+    for (auto _ : state) {
+        if constexpr (Columnar) {
+            benchmark::DoNotOptimize(co_ecs::columnar::load<first, second>(registry, data));
+        } else {
+            for (std::size_t i = 0; i < N; i++) {
+                registry.create<first, second>(first{ firsts[i] }, second{ seconds[i] });
+            }
+        }
+
+        state.PauseTiming();
+        registry.clear();
+        state.ResumeTiming();
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * (sizeof(first) + sizeof(second)) * N);
+}
+
+// Creates entities through commands and flushes them, optionally recording the flushed commands into a log
+template<std::size_t N, bool Record>
+static void command_flush(benchmark::State& state) {
+    using components_tuple = typename components_generator<foo_creator<64>, 2>::type;
+
+    std::apply([]<typename... Args>(Args&&...) { (co_ecs::component_serializers::add<Args>(), ...); },
+        components_tuple{});
+
+    auto registry = co_ecs::registry();
+    co_ecs::command_writer commands{ registry };
+    co_ecs::command_log log;
+    std::ostringstream file;
+    co_ecs::command_buffer::set_log(Record ? &log : nullptr);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; i++) {
+            std::apply([&]<typename... Args>(Args&&... args) { commands.create<Args...>(std::forward<Args>(args)...); },
+                components_tuple{});
+        }
+        co_ecs::command_buffer::flush(registry);
+
+        state.PauseTiming();
+        registry.clear();
+        log.drain(file);
+        file.str({});
+        state.ResumeTiming();
+    }
+
+    co_ecs::command_buffer::set_log(nullptr);
+    state.SetItemsProcessed(int64_t(state.iterations()) * N);
+}
+
+// Large component filled on construction, moving it copies all of its bytes
+template<std::size_t S>
+struct blob {
+    std::array<char, S> data;
+
+    explicit blob(char fill) noexcept {
+        data.fill(fill);
+    }
+};
+
+// Creates N entities with a large component, constructed on the stack and moved or constructed in place
+template<std::size_t N, std::size_t S, bool InPlace>
+static void create_large_component(benchmark::State& state) {
+    auto registry = co_ecs::registry();
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < N; i++) {
+            if constexpr (InPlace) {
+                registry.create(co_ecs::in_place<blob<S>>(static_cast<char>(i)));
+            } else {
+                registry.create<blob<S>>(blob<S>{ static_cast<char>(i) });
+            }
+        }
+
+        state.PauseTiming();
+        registry.clear();
+        state.ResumeTiming();
+    }
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * S * N);
+}
+
 BENCHMARK(entity_creation_with<0_components>);
 BENCHMARK(entity_creation_with<1_components, 64_bytes_each>);
 BENCHMARK(entity_creation_with<2_components, 64_bytes_each>);
@@ -178,3 +351,22 @@ BENCHMARK(iterate_entities_with_system<1000000_entities, 1_components, 64_bytes_
 BENCHMARK(iterate_entities_with_system<1000000_entities, 2_components, 64_bytes_each>)->Unit(benchmark::kMillisecond);
 BENCHMARK(iterate_entities_with_system<1000000_entities, 4_components, 64_bytes_each>)->Unit(benchmark::kMillisecond);
 BENCHMARK(iterate_entities_with_system<1000000_entities, 8_components, 64_bytes_each>)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(command_flush<10000_entities, false>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(command_flush<10000_entities, true>)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(iterate_co_accessed<1000000_entities, false>)->Unit(benchmark::kMillisecond);
+BENCHMARK(iterate_co_accessed<1000000_entities, true>)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(create_large_component<10000_entities, 256_bytes_each, false>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(create_large_component<10000_entities, 256_bytes_each, true>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(create_large_component<10000_entities, 512_bytes_each, false>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(create_large_component<10000_entities, 512_bytes_each, true>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(create_large_component<10000_entities, 1024_bytes_each, false>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(create_large_component<10000_entities, 1024_bytes_each, true>)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(type_erased_traversal<1000000_entities, false>)->Unit(benchmark::kMillisecond);
+BENCHMARK(type_erased_traversal<1000000_entities, true>)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(columnar_import<100000_entities, false>)->Unit(benchmark::kMillisecond);
+BENCHMARK(columnar_import<100000_entities, true>)->Unit(benchmark::kMillisecond);
@@ -26,8 +26,15 @@ struct write_component_b {
     float value;
 };
 
+struct lifetime {
+    int frames;
+};
+
 struct parallel_iter {};
 struct serial_iter {};
+struct affinity_iter {};
+struct recorded {};
+struct unrecorded {};
 
 template<std::size_t N, typename P>
 static void schedule_execution(benchmark::State& state) {
@@ -67,6 +74,84 @@ static void schedule_execution(benchmark::State& state) {
     }
 }
 
+// Repeated par_each over a working set that fits into the combined L2 caches of the workers, with affinity the chunks
+// processed by a worker in the previous frame are offered to it again
+template<std::size_t N, typename P>
+static void repeated_par_each(benchmark::State& state) {
+    thread_pool tp{ N };
+    registry reg;
+
+    for (auto i = 0; i < 64 * 1024; i++) {
+        reg.create<read_component_a, write_component_a>({ float(i) }, { 0.0 });
+    }
+
+    affinity_partitioner affinity;
+    auto view = reg.view<const read_component_a&, write_component_a&>();
+    auto func = [](const auto& r, auto& w) { w.value += r.value * 0.5f; };
+
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<P, affinity_iter>) {
+            view.par_each(func, affinity);
+        } else {
+            view.par_each(func);
+        }
+    }
+
+    if constexpr (std::is_same_v<P, affinity_iter>) {
+        auto batches = affinity.hits() + affinity.misses();
+        state.counters["affinity_hits"] = batches ? double(affinity.hits()) / double(batches) : 0.0;
+    }
+}
+
+// A frame of systems iterating all entities and respawning about one percent of them through commands, with and without
+// a command log recording the flush
+template<std::size_t N, typename P>
+static void frame_recording(benchmark::State& state) {
+    thread_pool tp{ N };
+    registry reg;
+
+    component_serializers::add<read_component_a>();
+    component_serializers::add<write_component_a>();
+    component_serializers::add<lifetime>();
+
+    for (auto i = 0; i < 100'000; i++) {
+        reg.create<read_component_a, write_component_a, lifetime>({ float(i) }, { 0.0 }, { i % 100 + 1 });
+    }
+
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([](co_ecs::view<const read_component_a&, write_component_a&> v) {
+                        v.each([](const auto& r, auto& w) { w.value += std::sin(r.value); });
+                    })
+                    .add_system([](command_writer cmd, co_ecs::view<const entity&, lifetime&> v) {
+                        v.each([&](const auto& ent, auto& l) {
+                            if (--l.frames == 0) {
+                                cmd.destroy(ent);
+                                cmd.create<read_component_a, write_component_a, lifetime>({ 1.0 }, { 0.0 }, { 100 });
+                            }
+                        });
+                    })
+                    .end_stage()
+                    .create_executor(reg);
+
+    command_log log;
+    if constexpr (std::is_same_v<P, recorded>) {
+        command_buffer::set_log(&log);
+    }
+
+    std::vector<std::byte> out;
+    std::size_t bytes{};
+    for (auto _ : state) {
+        log.begin_frame();
+        exec->run_once();
+        log.drain(out);
+        bytes += out.size();
+        out.clear();
+    }
+    command_buffer::set_log(nullptr);
+
+    state.counters["log_bytes"] = benchmark::Counter(double(bytes), benchmark::Counter::kAvgIterations);
+}
 
 BENCHMARK(schedule_execution<1_workers, serial_iter>)->Unit(benchmark::kMillisecond);
 BENCHMARK(schedule_execution<2_workers, serial_iter>)->Unit(benchmark::kMillisecond);
@@ -77,3 +162,13 @@ BENCHMARK(schedule_execution<1_workers, parallel_iter>)->Unit(benchmark::kMillis
 BENCHMARK(schedule_execution<2_workers, parallel_iter>)->Unit(benchmark::kMillisecond);
 BENCHMARK(schedule_execution<4_workers, parallel_iter>)->Unit(benchmark::kMillisecond);
 BENCHMARK(schedule_execution<8_workers, parallel_iter>)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(repeated_par_each<4_workers, parallel_iter>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(repeated_par_each<4_workers, affinity_iter>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(repeated_par_each<8_workers, parallel_iter>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(repeated_par_each<8_workers, affinity_iter>)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(frame_recording<1_workers, unrecorded>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(frame_recording<1_workers, recorded>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(frame_recording<4_workers, unrecorded>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(frame_recording<4_workers, recorded>)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <co_ecs/component.hpp>
+#include <co_ecs/detail/hash_map.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief How well chunk layouts match the recorded accesses
+struct layout_stats {
+    /// @brief Recorded view iterations over archetypes holding all of the view components
+    std::uint64_t accesses{};
+
+    /// @brief Accesses whose columns are adjacent blocks in the chunk, a single stream for the prefetcher
+    std::uint64_t contiguous{};
+
+    /// @brief Return the share of accesses reading adjacent columns
+    ///
+    /// @return double Hit rate in [0, 1] or 1 when nothing has been recorded yet
+    [[nodiscard]] auto hit_rate() const noexcept -> double {
+        return accesses ? static_cast<double>(contiguous) / static_cast<double>(accesses) : 1.0;
+    }
+};
+
+/// @brief Records which components views iterate together, used to place co-accessed columns next to each other in
+/// chunks. Recording is off by default and costs a relaxed atomic load per view iteration when off.
+///
+/// @code
+/// co_ecs::access_profile::enable(true);
+/// for (int i = 0; i < 100; i++) {
+///     executor->run_once();
+/// }
+/// auto before = co_ecs::chunk_layout::statistics(registry);
+/// co_ecs::chunk_layout::optimize(registry);
+/// auto after = co_ecs::chunk_layout::statistics(registry);
+/// @endcode
+class access_profile {
+public:
+    /// @brief Components iterated together and the number of iterations
+    struct access {
+        std::vector<component_id_t> components;
+        std::uint64_t count{};
+    };
+
+    /// @brief Turn recording on or off
+    ///
+    /// @param enabled Record accesses when true
+    static void enable(bool enabled) noexcept {
+        _enabled.store(enabled, std::memory_order::relaxed);
+    }
+
+    /// @brief Check if recording is on
+    ///
+    /// @return true If accesses are recorded
+    [[nodiscard]] static auto enabled() noexcept -> bool {
+        return _enabled.load(std::memory_order::relaxed);
+    }
+
+    /// @brief Record an iteration over components C
+    ///
+    /// @tparam C Component types
+    template<component... C>
+    static void record() {
+        if constexpr (sizeof...(C) > 1) {
+            if (!enabled()) [[likely]] {
+                return;
+            }
+            static const auto key = component_set::create<C...>();
+            static const auto ids = sorted_ids({ component_meta::of<C>().id... });
+            auto& profile = instance();
+            std::lock_guard lock(profile._mutex);
+            auto [it, inserted] = profile._accesses.insert({ key, access{ ids, 0 } });
+            it->second.count++;
+        }
+    }
+
+    /// @brief Drop all recorded accesses
+    static void reset() {
+        auto& profile = instance();
+        std::lock_guard lock(profile._mutex);
+        profile._accesses.clear();
+    }
+
+    /// @brief Return recorded accesses
+    ///
+    /// @return std::vector<access> Accesses
+    [[nodiscard]] static auto accesses() -> std::vector<access> {
+        auto& profile = instance();
+        std::lock_guard lock(profile._mutex);
+        std::vector<access> result;
+        result.reserve(profile._accesses.size());
+        for (const auto& [key, entry] : profile._accesses) {
+            result.push_back(entry);
+        }
+        return result;
+    }
+
+    /// @brief Order components so that components accessed together most often are adjacent. Starts from the most
+    /// accessed component and repeatedly appends the component accessed together with the last one most often, the
+    /// components never accessed together keep their relative order at the end.
+    ///
+    /// @param components Components of an archetype
+    /// @param accesses Recorded accesses
+    /// @return std::vector<component_meta> Ordered components
+    [[nodiscard]] static auto order(const component_meta_set& components, std::span<const access> accesses)
+        -> std::vector<component_meta> {
+        std::vector<component_meta> metas(components.begin(), components.end());
+        const auto size = metas.size();
+
+        auto index_of = [&](component_id_t id) -> std::size_t {
+            auto it = std::ranges::find(metas, id, &component_meta::id);
+            return static_cast<std::size_t>(it - metas.begin());
+        };
+
+        // pairwise weights of components iterated together within this archetype
+        std::vector<std::uint64_t> weights(size * size);
+        std::vector<std::uint64_t> totals(size);
+        for (const auto& entry : accesses) {
+            if (!contains_all(components, entry.components)) {
+                continue;
+            }
+            for (auto a : entry.components) {
+                for (auto b : entry.components) {
+                    if (a != b) {
+                        weights[index_of(a) * size + index_of(b)] += entry.count;
+                        totals[index_of(a)] += entry.count;
+                    }
+                }
+            }
+        }
+
+        std::vector<component_meta> ordered;
+        ordered.reserve(size);
+        std::vector<bool> placed(size);
+        auto pick = [&](auto&& score) {
+            std::size_t best = size;
+            for (std::size_t i = 0; i < size; i++) {
+                if (!placed[i] && totals[i] != 0 && (best == size || score(i) > score(best))) {
+                    best = i;
+                }
+            }
+            return best;
+        };
+
+        auto current = pick([&](std::size_t i) { return totals[i]; });
+        while (current != size) {
+            placed[current] = true;
+            ordered.push_back(metas[current]);
+            auto next = pick([&](std::size_t i) { return weights[current * size + i]; });
+            if (next != size && weights[current * size + next] == 0) {
+                next = pick([&](std::size_t i) { return totals[i]; });
+            }
+            current = next;
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            if (!placed[i]) {
+                ordered.push_back(metas[i]);
+            }
+        }
+        return ordered;
+    }
+
+    /// @brief Check if components of the archetype contain all components of an access
+    ///
+    /// @param components Components of an archetype
+    /// @param ids Accessed components
+    /// @return true If every accessed component is in the archetype
+    [[nodiscard]] static auto contains_all(const component_meta_set& components, std::span<const component_id_t> ids)
+        -> bool {
+        return std::ranges::all_of(ids, [&](auto id) { return components.contains(id); });
+    }
+
+private:
+    static auto sorted_ids(std::vector<component_id_t> ids) -> std::vector<component_id_t> {
+        std::ranges::sort(ids);
+        return ids;
+    }
+
+    static auto instance() -> access_profile& {
+        static access_profile profile;
+        return profile;
+    }
+
+    static inline std::atomic<bool> _enabled{};
+
+    std::mutex _mutex;
+    detail::hash_map<component_set, access, component_set_hasher> _accesses;
+};
+
+} // namespace co_ecs
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <co_ecs/registry.hpp>
+
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief Aggregate over a component maintained from per chunk summaries.
+///
+/// Every chunk holding C is summarized by folding its components with transform and combine starting with init. The
+/// summary is cached together with the chunk version and recomputed only when the chunk has changed since, so a query
+/// over a mostly static world touches only the chunks that were modified. Chunk summaries are then combined into the
+/// result.
+///
+/// @code
+/// auto max_threat = co_ecs::make_chunk_aggregate<threat>(
+///     0.0f, [](const threat& t) { return t.level; }, [](float a, float b) { return std::max(a, b); });
+/// auto any_dead = co_ecs::make_chunk_aggregate<health>(
+///     false, [](const health& h) { return h.value < 0; }, std::logical_or{});
+///
+/// if (any_dead.get(registry)) {
+///     ...
+/// }
+/// @endcode
+///
+/// @note Versions are tracked per chunk, a mutable access to any component of a chunk marks its summary dirty.
+///
+/// @tparam C Component type
+/// @tparam T Summary type
+/// @tparam Transform Callable converting const C& to T
+/// @tparam Combine Callable combining two T values
+template<component C, typename T, typename Transform, typename Combine>
+class chunk_aggregate {
+public:
+    /// @brief Construct a new chunk aggregate object
+    ///
+    /// @param init Identity value of the combine operation
+    /// @param transform Callable converting const C& to T
+    /// @param combine Callable combining two T values
+    chunk_aggregate(T init, Transform transform, Combine combine) :
+        _init(std::move(init)), _transform(std::move(transform)), _combine(std::move(combine)) {
+    }
+
+    /// @brief Compute the aggregate over all entities with component C, recomputing summaries of changed chunks only
+    ///
+    /// @param registry Registry
+    /// @return T Aggregated value or init when there are no entities with C
+    auto get(const registry& registry) -> T {
+        const auto& archetypes = registry.archetypes();
+        _summaries.resize(archetypes.size());
+
+        T result = _init;
+        for (std::size_t archetype_index = 0; archetype_index < archetypes.size(); archetype_index++) {
+            const auto* archetype = archetypes.by_index(archetype_index);
+            if (!archetype->template contains<C>()) {
+                continue;
+            }
+
+            const auto& chunks = archetype->chunks();
+            auto& summaries = _summaries[archetype_index];
+            summaries.resize(chunks.size());
+
+            for (std::size_t chunk_index = 0; chunk_index < chunks.size(); chunk_index++) {
+                const auto& chunk = chunks[chunk_index];
+                auto& summary = summaries[chunk_index];
+                if (summary.version != chunk.version()) {
+                    summary.value = summarize(chunk);
+                    summary.version = chunk.version();
+                    _recomputed++;
+                }
+                result = _combine(std::move(result), summary.value);
+            }
+        }
+
+        return result;
+    }
+
+    /// @brief Return the number of chunk summaries recomputed so far
+    ///
+    /// @return std::size_t Number of recomputed summaries
+    [[nodiscard]] auto recomputed() const noexcept -> std::size_t {
+        return _recomputed;
+    }
+
+private:
+    struct summary {
+        std::uint64_t version{};
+        T value{};
+    };
+
+    auto summarize(const chunk& chunk) -> T {
+        T acc = _init;
+        for (const auto& component : chunk_view<const C&>(chunk).template column<C>()) {
+            acc = _combine(std::move(acc), _transform(component));
+        }
+        return acc;
+    }
+
+    T _init;
+    Transform _transform;
+    Combine _combine;
+    std::vector<std::vector<summary>> _summaries;
+    std::size_t _recomputed{};
+};
+
+/// @brief Create a chunk aggregate over component C
+///
+/// @tparam C Component type
+/// @param init Identity value of the combine operation
+/// @param transform Callable converting const C& to T
+/// @param combine Callable combining two T values
+/// @return chunk_aggregate
+template<component C, typename T, typename Transform, typename Combine>
+auto make_chunk_aggregate(T init, Transform transform, Combine combine) -> chunk_aggregate<C, T, Transform, Combine> {
+    return chunk_aggregate<C, T, Transform, Combine>(std::move(init), std::move(transform), std::move(combine));
+}
+
+} // namespace co_ecs
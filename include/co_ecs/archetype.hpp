@@ -1,12 +1,15 @@
 #pragma once
 
+#include <co_ecs/access_profile.hpp>
 #include <co_ecs/chunk.hpp>
 #include <co_ecs/component.hpp>
 #include <co_ecs/detail/hash_map.hpp>
 #include <co_ecs/entity.hpp>
 #include <co_ecs/entity_location.hpp>
 
+#include <algorithm>
 #include <bit>
+#include <span>
 
 namespace co_ecs {
 
@@ -24,8 +27,15 @@ public:
     ///
     /// @param components Components
     explicit archetype(component_meta_set components) : _components(std::move(components)) {
-        _max_size = get_max_size(_components);
-        init_blocks(_components);
+        if (access_profile::enabled()) {
+            // place columns that are iterated together next to each other from the start
+            auto order = access_profile::order(_components, access_profile::accesses());
+            _max_size = get_max_size(order);
+            init_blocks(order);
+        } else {
+            _max_size = get_max_size(_components);
+            init_blocks(_components);
+        }
         _chunks.emplace_back(_blocks, _max_size);
     }
 
@@ -36,6 +46,59 @@ public:
         return _components;
     }
 
+    /// @brief Return number of entities in the archetype, all chunks but the last one are full
+    ///
+    /// @return std::size_t Number of entities
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return (_chunks.size() - 1) * _max_size + _chunks.back().size();
+    }
+
+    /// @brief Return components in the order of their blocks in chunks
+    ///
+    /// @return std::vector<component_id_t> Component IDs
+    [[nodiscard]] auto block_order() const -> std::vector<component_id_t> {
+        std::vector<const block_metadata*> blocks;
+        for (const auto& [id, block] : _blocks) {
+            if (id != component_meta::of<entity>().id) {
+                blocks.push_back(&block);
+            }
+        }
+        std::ranges::sort(blocks, {}, &block_metadata::offset);
+
+        std::vector<component_id_t> order;
+        order.reserve(blocks.size());
+        for (const auto* block : blocks) {
+            order.push_back(block->meta.id);
+        }
+        return order;
+    }
+
+    /// @brief Place blocks of components in the given order, moving the components of all chunks. Keeps the current
+    /// layout when the order does not fit the chunk capacity. Must not be called concurrently with any other access to
+    /// the archetype.
+    ///
+    /// @param order Components of this archetype in the new block order
+    /// @return true If the layout has been changed
+    auto relayout(std::span<const component_meta> order) -> bool {
+        if (std::ranges::equal(order, block_order(), {}, &component_meta::id)) {
+            return false;
+        }
+
+        // spare chunks hold slab pointers in the current layout, release them while it is still valid
+        _spare_chunks.clear();
+
+        auto blocks = std::exchange(_blocks, {});
+        if (init_blocks(order) > chunk::chunk_bytes) {
+            _blocks = std::move(blocks);
+            return false;
+        }
+        // chunks refer to _blocks which now holds the new layout
+        for (auto& chunk : _chunks) {
+            chunk.relayout(blocks);
+        }
+        return true;
+    }
+
     /// @brief Return reference to chunks vector
     ///
     /// @return chunks_storage_t&
@@ -54,9 +117,9 @@ public:
     ///
     /// @tparam Components Components types
     /// @param ent Entity
-    /// @param components Components parameter pack
+    /// @param components Component values or in_place_t arguments
     /// @return entity_location
-    template<component... Components>
+    template<component_argument... Components>
     auto emplace(entity ent, Components&&... components) -> entity_location {
         auto& free_chunk = ensure_free_chunk();
         auto entry_index = free_chunk.size();
@@ -69,6 +132,29 @@ public:
         };
     }
 
+    /// @brief Append entities with components copied as raw bytes from columns, filling chunks a block at a time. All
+    /// components of the archetype must be trivially copyable.
+    ///
+    /// @param entities Entities to append
+    /// @param source Function returning the first byte of the source column of a component_meta for all entities
+    /// @param placed Function called with every appended entity and its location
+    void append_raw(std::span<const entity> entities, auto&& source, auto&& placed) {
+        std::size_t done{};
+        while (done < entities.size()) {
+            auto& free_chunk = ensure_free_chunk();
+            auto chunk_index = _chunks.size() - 1;
+            auto first = free_chunk.size();
+            auto count = std::min(entities.size() - done, free_chunk.max_size() - first);
+            free_chunk.append_raw(entities.subspan(done, count), [&](const component_meta& meta) -> const std::byte* {
+                return source(meta) + done * meta.type->size;
+            });
+            for (std::size_t i = 0; i < count; i++) {
+                placed(entities[done + i], entity_location{ this, chunk_index, first + i });
+            }
+            done += count;
+        }
+    }
+
     /// @brief Swap erase an entity at given location, returns an entity that has been moved as a result of this
     /// operation or std::nullopt if no entities were moved
     ///
@@ -84,6 +170,63 @@ public:
         return maybe_ent;
     }
 
+    /// @brief Erase entities at given rows in a single compaction pass. Holes below the new size are filled with the
+    /// surviving entities from the tail, then the tail is truncated.
+    ///
+    /// A row is the position of an entity across chunks, chunk_index * max_size + entry_index, which is well defined
+    /// since every chunk but the last one is full.
+    ///
+    /// @param rows Rows to erase, sorted in ascending order without duplicates
+    /// @param on_move Callback invoked with every moved entity and its new location
+    void erase_rows(std::span<const std::size_t> rows, auto&& on_move) noexcept {
+        if (rows.empty()) {
+            return;
+        }
+
+        const auto size = (_chunks.size() - 1) * _max_size + _chunks.back().size();
+        const auto new_size = size - rows.size();
+
+        auto hole = rows.begin();
+        auto holes_end = std::ranges::lower_bound(rows, new_size);
+        auto erased_tail = holes_end;
+
+        for (auto row = new_size; row < size && hole != holes_end; row++) {
+            if (erased_tail != rows.end() && *erased_tail == row) {
+                ++erased_tail;
+                continue;
+            }
+            auto chunk_index = *hole / _max_size;
+            auto entry_index = *hole % _max_size;
+            auto moved = _chunks[chunk_index].replace(entry_index, _chunks[row / _max_size], row % _max_size);
+            on_move(moved, entity_location{ this, chunk_index, entry_index });
+            ++hole;
+        }
+
+        // truncate the tail, keeping at least one chunk
+        for (auto chunk_index = _chunks.size(); chunk_index-- > 0;) {
+            auto chunk_begin = chunk_index * _max_size;
+            if (chunk_begin + _chunks[chunk_index].size() <= new_size) {
+                break;
+            }
+            _chunks[chunk_index].truncate(new_size > chunk_begin ? new_size - chunk_begin : 0);
+            if (_chunks[chunk_index].empty() && _chunks.size() > 1) {
+                _chunks.pop_back();
+            }
+        }
+    }
+
+    /// @brief Destroy all entities. Emptied chunks are kept aside and reused by the following insertions instead of
+    /// allocating new ones.
+    void clear() noexcept {
+        for (auto& chunk : _chunks) {
+            chunk.clear();
+        }
+        while (_chunks.size() > 1) {
+            _spare_chunks.emplace_back(std::move(_chunks.back()));
+            _chunks.pop_back();
+        }
+    }
+
     /// @brief Move entity and its components to a different archetype and returns a pair where the first element is
     /// moved entity location in a new archetype and the second is the entity that has been moved in this archetype or
     /// std::nullopt if no entities were moved
@@ -143,6 +286,26 @@ public:
         get_chunk(location).visit(location.entry_index, std::forward<decltype(func)>(func));
     }
 
+    /// @brief Visit component columns of every chunk
+    ///
+    /// @param func Function called with chunk entities and a component_column per component per chunk
+    void visit_columns(auto&& func) {
+        for (auto& chunk : _chunks) {
+            auto entities = chunk.entities();
+            chunk.visit_columns([&](component_column column) { func(entities, column); });
+        }
+    }
+
+    /// @brief Visit component columns of every chunk (const variant).
+    ///
+    /// @param func Function called with chunk entities and a const_component_column per component per chunk
+    void visit_columns(auto&& func) const {
+        for (const auto& chunk : _chunks) {
+            auto entities = chunk.entities();
+            chunk.visit_columns([&](const_component_column column) { func(entities, column); });
+        }
+    }
+
     /// @brief Get component data
     ///
     /// @tparam C Component type
@@ -174,7 +337,7 @@ public:
     }
 
 private:
-    void init_blocks(const component_meta_set& components_meta) {
+    auto init_blocks(auto&& components_meta) -> std::size_t {
         // make space for entity
         auto offset = add_block(0, component_meta::of<entity>());
 
@@ -182,13 +345,16 @@ private:
         for (const auto& meta : components_meta) {
             offset = add_block(offset, meta);
         }
+        return offset;
     }
 
     auto add_block(std::size_t offset, const component_meta& meta) -> std::size_t {
-        const std::size_t size_in_bytes = _max_size * meta.type->size;
-        const std::size_t align = meta.type->align;
+        // out of line blocks hold a single pointer to the slab with components
+        const bool out_of_line = chunk::is_out_of_line(meta);
+        const std::size_t size_in_bytes = out_of_line ? sizeof(std::byte*) : _max_size * meta.type->size;
+        const std::size_t align = out_of_line ? alignof(std::byte*) : meta.type->align;
 
-        _blocks.emplace(meta.id, offset, meta);
+        _blocks.emplace(meta.id, offset, meta, out_of_line);
 
         offset += detail::mod_2n(offset, align) + size_in_bytes;
 
@@ -223,12 +389,14 @@ private:
         return remaining_elements_count + 1;
     }
 
-    // Calculate size of packed structure of components
+    // Calculate size of packed structure of components, out of line components do not take space per entity
     static auto packed_components_size(auto&& components_meta) noexcept -> std::size_t {
         return std::accumulate(components_meta.begin(),
             components_meta.end(),
             component_meta::of<entity>().type->size,
-            [](const auto& res, const auto& meta) { return res + meta.type->size; });
+            [](const auto& res, const auto& meta) {
+                return res + (chunk::is_out_of_line(meta) ? 0 : meta.type->size);
+            });
     }
 
     // Calculate size of properly aligned structure of components
@@ -238,8 +406,10 @@ private:
 
         // Add single component element size accounting for its alignment
         auto add_elements = [&end](const component_meta& meta) {
-            end += detail::mod_2n(std::bit_cast<std::size_t>(end), meta.type->align);
-            end += meta.type->size;
+            const bool out_of_line = chunk::is_out_of_line(meta);
+            const auto align = out_of_line ? alignof(std::byte*) : meta.type->align;
+            end += detail::mod_2n(std::bit_cast<std::size_t>(end), align);
+            end += out_of_line ? sizeof(std::byte*) : meta.type->size;
         };
 
         add_elements(component_meta::of<entity>());
@@ -277,7 +447,17 @@ private:
         if (!chunk.full()) {
             return chunk;
         }
-        _chunks.emplace_back(_blocks, _max_size);
+        // a new chunk continues the range of the previous one, place it on the same NUMA node
+        auto node = chunk.node();
+        if (!_spare_chunks.empty()) {
+            _chunks.emplace_back(std::move(_spare_chunks.back()));
+            _spare_chunks.pop_back();
+            if (_chunks.back().node() != node) {
+                _chunks.back().bind(node);
+            }
+        } else {
+            _chunks.emplace_back(_blocks, _max_size, node);
+        }
         return _chunks.back();
     }
 
@@ -286,6 +466,7 @@ private:
     blocks_type _blocks{};
     component_meta_set _components{};
     chunks_storage_t _chunks{};
+    chunks_storage_t _spare_chunks{};
 };
 
 /// @brief Container for archetypes, holds a map from component set to archetype
@@ -307,6 +488,7 @@ public:
         auto& archetype = _archetypes[components.ids()];
         if (!archetype) {
             archetype = create_archetype(components);
+            _archetypes_by_index.emplace_back(archetype.get());
         }
         assert((archetype->components().ids() == components.ids())
                && "Archetype components do not match the search request");
@@ -325,6 +507,7 @@ public:
         auto& archetype = _archetypes[_search_component_set];
         if (!archetype) {
             archetype = create_archetype(component_meta_set::create<Components...>());
+            _archetypes_by_index.emplace_back(archetype.get());
         }
         assert((archetype->components().ids() == _search_component_set)
                && "Archetype components do not match the search request");
@@ -344,6 +527,7 @@ public:
         auto& archetype = _archetypes[_search_component_set];
         if (!archetype) {
             archetype = create_archetype_added<Components...>(anchor_archetype);
+            _archetypes_by_index.emplace_back(archetype.get());
         }
         assert((archetype->components().ids() == _search_component_set)
                && "Archetype components do not match the search request");
@@ -363,6 +547,7 @@ public:
         auto& archetype = _archetypes[_search_component_set];
         if (!archetype) {
             archetype = create_archetype_removed<Components...>(anchor_archetype);
+            _archetypes_by_index.emplace_back(archetype.get());
         }
         assert((archetype->components().ids() == _search_component_set)
                && "Archetype components do not match the search request");
@@ -404,6 +589,25 @@ public:
         return _archetypes.size();
     }
 
+    /// @brief Get archetype by its index. Archetypes are indexed in creation order and an archetype keeps its index
+    /// for its whole lifetime, unlike its position in the hash map which changes on rehash.
+    ///
+    /// @param index Archetype index, must be less than size()
+    /// @return archetype*
+    [[nodiscard]] auto by_index(std::size_t index) noexcept -> archetype* {
+        assert((index < _archetypes_by_index.size()) && "Archetype index out of range");
+        return _archetypes_by_index[index];
+    }
+
+    /// @brief Get archetype by its index, const variant.
+    ///
+    /// @param index Archetype index, must be less than size()
+    /// @return const archetype*
+    [[nodiscard]] auto by_index(std::size_t index) const noexcept -> const archetype* {
+        assert((index < _archetypes_by_index.size()) && "Archetype index out of range");
+        return _archetypes_by_index[index];
+    }
+
 private:
     static auto create_archetype(auto&& components) -> std::unique_ptr<archetype> {
         return std::make_unique<archetype>(std::forward<decltype(components)>(components));
@@ -432,6 +636,7 @@ private:
     component_set _search_component_set{};
 
     storage_type _archetypes{};
+    std::vector<archetype*> _archetypes_by_index{};
 };
 
 } // namespace co_ecs
\ No newline at end of file
@@ -4,8 +4,18 @@
 #include <co_ecs/component.hpp>
 #include <co_ecs/detail/sparse_map.hpp>
 #include <co_ecs/detail/type_traits.hpp>
+#include <co_ecs/detail/value_index.hpp>
 #include <co_ecs/entity.hpp>
 #include <co_ecs/entity_location.hpp>
+#include <co_ecs/exceptions.hpp>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace co_ecs {
 
@@ -63,9 +73,155 @@ public:
             set_location(moved->id(), location);
         }
 
+        index_erase(ent);
         _entity_pool.recycle(ent);
     }
 
+    /// @brief Destroys the given entities.
+    ///
+    /// Entities are grouped by archetype and every archetype is compacted in a single pass, the holes are filled with
+    /// surviving entities from the tail instead of swap erasing entities one by one. Entity IDs are recycled at once.
+    /// Duplicated entities are destroyed once. Throws entity_not_found before destroying anything if any of the
+    /// entities is not alive.
+    ///
+    /// @code
+    /// registry.destroy(std::span{ entities });
+    /// @endcode
+    /// @param entities Entities to destroy
+    void destroy(std::span<const entity> entities) {
+        std::vector<std::pair<archetype*, std::size_t>> rows;
+        rows.reserve(entities.size());
+        for (auto ent : entities) {
+            const auto& location = get_location(ent);
+            auto max_size = location.archetype->chunks().front().max_size();
+            rows.emplace_back(location.archetype, location.chunk_index * max_size + location.entry_index);
+        }
+
+        std::ranges::sort(rows);
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        std::vector<std::size_t> archetype_rows;
+        for (auto it = rows.begin(); it != rows.end();) {
+            auto* archetype = it->first;
+            archetype_rows.clear();
+            for (; it != rows.end() && it->first == archetype; ++it) {
+                archetype_rows.push_back(it->second);
+            }
+            archetype->erase_rows(archetype_rows, [this](entity moved, const entity_location& location) {
+                set_location(moved.id(), location);
+            });
+        }
+
+        for (auto ent : entities) {
+            remove_location(ent.id());
+            index_erase(ent);
+        }
+
+        _entity_pool.recycle(entities);
+    }
+
+    /// @brief Destroys all entities.
+    ///
+    /// Components are destroyed chunk by chunk, block by block, skipping trivially destructible ones. Entity IDs and
+    /// locations are reset in bulk, archetypes and their chunks are kept to be reused, so repopulating the registry
+    /// does not allocate them again. All entities created before are no longer alive.
+    ///
+    /// @code
+    /// registry.clear();
+    /// @endcode
+    void clear() {
+        for (auto& [_, archetype] : _archetypes) {
+            archetype->clear();
+        }
+        _entity_archetype_map.clear();
+        _entity_pool.clear();
+        for (auto& index : _indices) {
+            index->clear();
+        }
+        _index_updates.clear();
+    }
+
+    /// @brief Adds a hash index mapping a key derived from component C to the entity holding it.
+    ///
+    /// Entities already holding C are indexed right away. The index is then maintained by structural changes: creating
+    /// and destroying entities, setting, inserting and removing C, moving and cloning entities. Keys are expected to be
+    /// unique, when two entities share a key the one indexed last is found. Replacing an existing index on C drops it.
+    ///
+    /// @code
+    /// registry.add_index<network_id>(&network_id::value);
+    /// registry.get_entity(e).set<network_id>(42u);
+    /// auto found = registry.lookup<network_id>(42u); // e
+    /// @endcode
+    ///
+    /// @note Keys changed in place, through a view or a component reference, are not noticed. Change the key with
+    /// entity_ref::set() or call reindex() afterwards.
+    ///
+    /// @tparam C Component type
+    /// @param key_func Callable or member pointer deriving the key from const C&
+    template<component C>
+    void add_index(auto&& key_func) {
+        using key_type = std::decay_t<std::invoke_result_t<decltype(key_func), const C&>>;
+        auto index = std::make_unique<detail::value_index<C, key_type>>(
+            [func = std::forward<decltype(key_func)>(key_func)](const C& c) -> key_type {
+                return std::invoke(func, c);
+            });
+
+        auto id = component_meta::of<C>().id;
+        for (auto& [_, archetype] : _archetypes) {
+            if (!archetype->template contains<C>()) {
+                continue;
+            }
+            auto& chunks = archetype->chunks();
+            for (std::size_t chunk_index = 0; chunk_index < chunks.size(); chunk_index++) {
+                for (std::size_t entry_index = 0; entry_index < chunks[chunk_index].size(); entry_index++) {
+                    auto ent = *chunks[chunk_index].template ptr_unchecked<entity>(entry_index);
+                    index->update(ent, entity_location{ archetype.get(), chunk_index, entry_index });
+                }
+            }
+        }
+
+        std::erase_if(_indices, [id](const auto& other) { return other->component_id() == id; });
+        _indices.emplace_back(std::move(index));
+    }
+
+    /// @brief Removes the index on component C, if any.
+    ///
+    /// @tparam C Component type
+    template<component C>
+    void remove_index() {
+        auto id = component_meta::of<C>().id;
+        std::erase_if(_indices, [id](const auto& index) { return index->component_id() == id; });
+    }
+
+    /// @brief Finds the entity holding key in the index on component C in O(1).
+    ///
+    /// Throws index_not_found when there is no index on C whose key type is Key.
+    ///
+    /// @tparam C Component type
+    /// @tparam Key Key type, has to match the type returned by the key function of the index
+    /// @param key Key
+    /// @return std::optional<entity> Entity or std::nullopt when no entity holds the key
+    template<component C, typename Key>
+    [[nodiscard]] auto lookup(const Key& key) const -> std::optional<entity> {
+        auto id = component_meta::of<C>().id;
+        for (const auto& index : _indices) {
+            if (index->component_id() != id) {
+                continue;
+            }
+            if (const auto* typed = dynamic_cast<const detail::value_index<C, Key>*>(index.get())) {
+                return typed->find(key);
+            }
+        }
+        throw index_not_found{ component_meta::of<C>().type };
+    }
+
+    /// @brief Re-reads the keys of an entity after C was changed in place.
+    ///
+    /// @param ent Entity
+    void reindex(entity ent) {
+        index_update(ent);
+    }
+
     /// @brief Provides access to the modifiable list of archetypes in the registry.
     ///
     /// This method returns a reference to the internal container of archetypes, allowing for modifications
@@ -133,22 +289,92 @@ public:
         archetype.visit(location, std::forward<decltype(func)>(func));
     }
 
+    /// @brief Create entities with trivially copyable components C copied from contiguous arrays. The archetype is
+    /// resolved once and chunks are filled column by column without per-entity calls.
+    ///
+    /// @code
+    /// std::vector<position> positions = load_positions();
+    /// std::vector<velocity> velocities = load_velocities();
+    /// auto entities = registry.create_columns<position, velocity>(positions, velocities);
+    /// @endcode
+    ///
+    /// @tparam C Component types
+    /// @param columns Components, one array per component type of equal sizes
+    /// @return std::vector<entity> Created entities, in the order of the rows
+    template<component... C>
+        requires(sizeof...(C) > 0 && (std::is_trivially_copyable_v<C> && ...))
+    auto create_columns(std::span<const C>... columns) -> std::vector<entity> {
+        [[maybe_unused]] detail::unique_types<C...> uniqueness_check;
+
+        const auto count = std::get<0>(std::tie(columns...)).size();
+        if (((columns.size() != count) || ...)) {
+            throw std::invalid_argument("Columns must have the same number of rows");
+        }
+        auto* archetype = _archetypes.ensure_archetype<C...>();
+        return create_raw(*archetype, count, [&](const component_meta& meta) {
+            const std::byte* data{};
+            (..., (meta.id == component_meta::of<C>().id ? (data = std::as_bytes(columns).data()) : nullptr));
+            return data;
+        });
+    }
+
+    /// @brief Visit component columns of all chunks in the order archetypes were created. Type-erased tools such as
+    /// serializers or inspectors process whole columns at once instead of paying a call per component per entity.
+    ///
+    /// @code
+    /// registry.visit_columns([](std::span<const entity> entities, const_component_column column) {
+    ///     out.write(column.data, column.stride * column.count);
+    /// });
+    /// @endcode
+    ///
+    /// @param func Function called with chunk entities and a column per component per chunk
+    constexpr void visit_columns(auto&& func) {
+        for (std::size_t index = 0; index < _archetypes.size(); index++) {
+            _archetypes.by_index(index)->visit_columns(func);
+        }
+    }
+
+    /// @brief Visit component columns of all chunks (const variant).
+    ///
+    /// @param func Function called with chunk entities and a const_component_column per component per chunk
+    constexpr void visit_columns(auto&& func) const {
+        for (std::size_t index = 0; index < _archetypes.size(); index++) {
+            std::as_const(_archetypes).by_index(index)->visit_columns(func);
+        }
+    }
+
 protected:
     friend class entity_ref;
     friend class const_entity_ref;
+    friend class columnar;
 
-    template<component... Components>
-    constexpr auto create_impl(Components&&... args) -> entity {
+    template<component_argument... Args>
+    constexpr auto create_impl(Args&&... args) -> entity {
         // compile-time check to make sure all component types in parameter pack are unique
-        [[maybe_unused]] detail::unique_types<Components...> uniqueness_check;
+        [[maybe_unused]] detail::unique_types<constructed_component_t<Args>...> uniqueness_check;
 
         auto entity = allocate();
-        auto archetype = _archetypes.ensure_archetype<Components...>();
-        auto location = archetype->template emplace<Components...>(entity, std::forward<Components>(args)...);
+        auto archetype = _archetypes.ensure_archetype<constructed_component_t<Args>...>();
+        auto location = archetype->emplace(entity, std::forward<Args>(args)...);
         set_location(entity.id(), location);
+        index_update(entity);
         return entity;
     }
 
+    // Creates count entities in the archetype with components copied from raw columns returned by source
+    auto create_raw(archetype& target, std::size_t count, auto&& source) -> std::vector<entity> {
+        std::vector<entity> entities;
+        entities.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            entities.push_back(allocate());
+        }
+        target.append_raw(entities, source, [this](entity ent, const entity_location& location) {
+            set_location(ent.id(), location);
+            index_update(ent);
+        });
+        return entities;
+    }
+
     template<component C>
     constexpr auto set_impl(entity ent) -> std::pair<bool, C*> {
         auto& location = get_location(ent);
@@ -189,6 +415,7 @@ protected:
 
         archetype = new_archetype;
         set_location(ent.id(), new_location);
+        index_update(ent);
     }
 
     template<component... Args>
@@ -226,6 +453,7 @@ protected:
         if (moved && moved != ent) { // moved entity has been transfered to a different Registry
             set_location(moved->id(), location);
         }
+        index_erase(ent);
         _entity_pool.recycle(ent);
 
         // TODO: handle inside Archetype
@@ -235,6 +463,7 @@ protected:
              .ptr_unchecked<entity>(new_location.entry_index) = placeholder; // update entity value in the Chunk
 
         dest.set_location(placeholder.get_entity().id(), new_location);
+        dest.index_update(placeholder);
 
         return placeholder;
     }
@@ -252,6 +481,7 @@ protected:
              .ptr_unchecked<entity>(new_location.entry_index) = placeholder; // update EntityId value in the Chunk
 
         dest.set_location(placeholder.get_entity().id(), new_location);
+        dest.index_update(placeholder);
 
         return placeholder;
     }
@@ -264,7 +494,59 @@ protected:
         return copy(ent, *this, placeholder);
     }
 
+    /// @brief Updates indices after a structural change of an entity, deferred while index updates are batched
+    ///
+    /// @param ent Entity
+    void index_update(entity ent) {
+        if (_indices.empty()) {
+            return;
+        }
+        if (_index_batch_depth != 0) {
+            _index_updates.push_back(ent);
+            return;
+        }
+        const auto& location = get_location(ent);
+        for (auto& index : _indices) {
+            index->update(ent, location);
+        }
+    }
+
+    /// @brief Drops a destroyed entity from indices, deferred while index updates are batched
+    ///
+    /// @param ent Entity
+    void index_erase(entity ent) {
+        if (_indices.empty()) {
+            return;
+        }
+        if (_index_batch_depth != 0) {
+            _index_updates.push_back(ent);
+            return;
+        }
+        for (auto& index : _indices) {
+            index->erase(ent);
+        }
+    }
+
 private:
+    friend class deferred_index_updates;
+
+    void apply_index_updates() {
+        // entities are visited in the order of changes, so a recycled ID is dropped before it is indexed again
+        for (auto ent : _index_updates) {
+            if (alive(ent)) {
+                const auto& location = get_location(ent);
+                for (auto& index : _indices) {
+                    index->update(ent, location);
+                }
+            } else {
+                for (auto& index : _indices) {
+                    index->erase(ent);
+                }
+            }
+        }
+        _index_updates.clear();
+    }
+
     constexpr void ensure_alive(const entity& ent) const {
         if (!alive(ent)) {
             throw entity_not_found{ ent };
@@ -293,6 +575,36 @@ protected:
     entity_pool _entity_pool;
     class archetypes _archetypes;
     detail::sparse_map<typename entity::id_t, entity_location> _entity_archetype_map;
+    std::vector<std::unique_ptr<detail::value_index_base>> _indices;
+    std::vector<entity> _index_updates;
+    std::size_t _index_batch_depth{};
+};
+
+/// @brief Batches index maintenance of a registry for the lifetime of this object.
+///
+/// Structural changes only record the entities they touch, indices are brought up to date once when the outermost
+/// batch ends. Command buffer flush batches index updates this way. Lookups within the batch may return stale results.
+class deferred_index_updates {
+public:
+    /// @brief Start batching index updates
+    ///
+    /// @param registry Registry
+    explicit deferred_index_updates(base_registry& registry) noexcept : _registry(registry) {
+        _registry._index_batch_depth++;
+    }
+
+    /// @brief Apply recorded index updates when this is the outermost batch
+    ~deferred_index_updates() {
+        if (--_registry._index_batch_depth == 0) {
+            _registry.apply_index_updates();
+        }
+    }
+
+    deferred_index_updates(const deferred_index_updates&) = delete;
+    deferred_index_updates& operator=(const deferred_index_updates&) = delete;
+
+private:
+    base_registry& _registry;
 };
 
 
@@ -1,14 +1,24 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <optional>
+#include <span>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <co_ecs/component.hpp>
+#include <co_ecs/detail/allocator/slab_pool.hpp>
 #include <co_ecs/detail/bits.hpp>
+#include <co_ecs/detail/codec.hpp>
+#include <co_ecs/detail/numa.hpp>
 #include <co_ecs/detail/sparse_map.hpp>
 #include <co_ecs/detail/views.hpp>
 #include <co_ecs/entity.hpp>
@@ -24,13 +34,69 @@ namespace co_ecs {
 struct block_metadata {
     std::size_t offset{};
     component_meta meta{};
+    bool out_of_line{}; ///< Components are stored in a slab, the block holds a pointer to it
 
-    block_metadata(std::size_t offset, const component_meta& meta) noexcept : offset(offset), meta(meta) {
+    block_metadata(std::size_t offset, const component_meta& meta, bool out_of_line = false) noexcept :
+        offset(offset), meta(meta), out_of_line(out_of_line) {
     }
 };
 
 using blocks_type = detail::sparse_map<component_id_t, block_metadata>;
 
+/// @brief Type-erased column of a component in a chunk, count components stride bytes apart starting at data
+///
+/// @tparam P Pointer type, void* or const void*
+template<typename P>
+struct basic_component_column {
+    component_meta meta{};   ///< Component metadata
+    P data{};                ///< First component
+    std::size_t stride{};    ///< Distance between components in bytes
+    std::size_t count{};     ///< Number of components
+
+    /// @brief Return pointer to the component at index
+    ///
+    /// @param index Index
+    /// @return P Component pointer
+    [[nodiscard]] auto at(std::size_t index) const noexcept -> P {
+        using byte_ptr = std::conditional_t<std::is_const_v<std::remove_pointer_t<P>>, const std::byte*, std::byte*>;
+        return static_cast<byte_ptr>(data) + index * stride;
+    }
+};
+
+/// @brief Mutable component column
+using component_column = basic_component_column<void*>;
+
+/// @brief Const component column
+using const_component_column = basic_component_column<const void*>;
+
+/// @brief Chunk compression statistics accumulated over all chunks
+struct compression_stats {
+    /// @brief Number of chunks currently compressed
+    std::uint64_t compressed_chunks{};
+
+    /// @brief Number of times a chunk has been compressed
+    std::uint64_t compressions{};
+
+    /// @brief Total size of chunk data before compression
+    std::uint64_t uncompressed_bytes{};
+
+    /// @brief Total size of chunk data after compression
+    std::uint64_t compressed_bytes{};
+
+    /// @brief Number of accesses that had to decompress a chunk first
+    std::uint64_t stalls{};
+
+    /// @brief Total time spent decompressing on access
+    std::chrono::nanoseconds stall_time{};
+
+    /// @brief Return compression ratio, uncompressed size divided by compressed size
+    ///
+    /// @return double Compression ratio or 1 when nothing has been compressed yet
+    [[nodiscard]] auto ratio() const noexcept -> double {
+        return compressed_bytes ? static_cast<double>(uncompressed_bytes) / static_cast<double>(compressed_bytes) : 1.0;
+    }
+};
+
 /// @brief Chunk holds a 16 Kb block of memory that holds components in blocks:
 /// |A1|A2|A3|...padding|B1|B2|B3|...padding|C1|C2|C3...padding where A, B, C are component types and A1, B1, C1 and
 /// others are components instances.
@@ -42,8 +108,17 @@ public:
     /// @brief Block allocation alignment
     static constexpr std::size_t alloc_alignment = alignof(entity);
 
-    /// @brief Chunk buffer type
-    struct alignas(alloc_alignment) chunk_buffer {
+    /// @brief Components larger than this are stored out of line, so they do not shrink the chunk capacity
+    static constexpr std::size_t out_of_line_threshold = 256;
+
+    /// @brief Initial capacity of out of line columns
+    static constexpr std::size_t out_of_line_initial_capacity = 8;
+
+    /// @brief Number of parallel passes from a different NUMA node after which chunk memory is moved to that node
+    static constexpr std::uint32_t node_migration_threshold = 4;
+
+    /// @brief Chunk buffer type, page aligned so that it can be bound to a NUMA node
+    struct alignas(detail::numa::page_size) chunk_buffer {
         std::byte data[chunk_bytes];
     };
 
@@ -51,8 +126,24 @@ public:
     ///
     /// @param blocks Component blocks
     /// @param max_size Maxium size of entries this chunk can hold
-    chunk(const blocks_type& blocks, std::size_t max_size) :
-        _blocks(&blocks), _max_size(max_size), _buffer((new chunk_buffer)->data) {
+    /// @param node NUMA node to place the chunk memory on
+    chunk(const blocks_type& blocks, std::size_t max_size, std::size_t node = detail::numa::unknown_node) :
+        _blocks(&blocks), _max_size(max_size), _buffer(allocate_buffer()), _version(next_version()) {
+        bind(node);
+        for (const auto& [id, block] : *_blocks) {
+            if (block.out_of_line) {
+                _out_of_line = true;
+                set_slab(block, nullptr);
+            }
+        }
+    }
+
+    /// @brief Check if components of the given type are stored out of line
+    ///
+    /// @param meta Component meta
+    /// @return true If the component is stored out of line
+    [[nodiscard]] static constexpr auto is_out_of_line(const component_meta& meta) noexcept -> bool {
+        return meta.type->size > out_of_line_threshold && meta.type->align <= detail::slab_pool::slab_alignment;
     }
 
     /// @brief Deleted copy constructor
@@ -69,7 +160,11 @@ public:
     ///
     /// @param rhs Another chunk
     chunk(chunk&& rhs) noexcept :
-        _buffer(std::exchange(rhs._buffer, nullptr)), _size(rhs._size), _max_size(rhs._max_size), _blocks(rhs._blocks) {
+        _buffer(rhs._buffer.exchange(nullptr, std::memory_order::relaxed)), _size(rhs._size), _max_size(rhs._max_size),
+        _blocks(rhs._blocks), _version(rhs._version.load(std::memory_order::relaxed)),
+        _compressed(std::move(rhs._compressed)), _out_of_line(rhs._out_of_line),
+        _out_of_line_capacity(std::exchange(rhs._out_of_line_capacity, 0)),
+        _node(rhs._node.load(std::memory_order::relaxed)), _woken(rhs._woken.load(std::memory_order::relaxed)) {
     }
 
     /// @brief Move assignment operator
@@ -77,37 +172,84 @@ public:
     /// @param rhs Right hand side chunk
     /// @return chunk& Resulting chunk
     auto operator=(chunk&& rhs) noexcept -> chunk& {
-        _buffer = std::exchange(rhs._buffer, _buffer);
+        _buffer.store(rhs._buffer.exchange(_buffer.load(std::memory_order::relaxed), std::memory_order::relaxed),
+            std::memory_order::relaxed);
+        _compressed.swap(rhs._compressed);
         _size = std::exchange(rhs._size, _size);
         _max_size = std::exchange(rhs._max_size, _max_size);
         _blocks = std::exchange(rhs._blocks, _blocks);
+        _version.store(rhs._version.exchange(_version.load(std::memory_order::relaxed), std::memory_order::relaxed),
+            std::memory_order::relaxed);
+        _out_of_line = std::exchange(rhs._out_of_line, _out_of_line);
+        _out_of_line_capacity = std::exchange(rhs._out_of_line_capacity, _out_of_line_capacity);
+        _node.store(rhs._node.exchange(_node.load(std::memory_order::relaxed), std::memory_order::relaxed),
+            std::memory_order::relaxed);
+        _woken.store(rhs._woken.exchange(_woken.load(std::memory_order::relaxed), std::memory_order::relaxed),
+            std::memory_order::relaxed);
+        _node_misses.store(0, std::memory_order::relaxed);
         return *this;
     }
 
     /// @brief Destroy the chunk object
     ~chunk() {
-        if (_buffer == nullptr) {
+        auto* buffer = _buffer.load(std::memory_order::relaxed);
+        if (buffer == nullptr) {
+            // compressed chunks hold trivially copyable components only, nothing to destruct
+            if (!_compressed.empty()) {
+                counters().compressed_chunks.fetch_sub(1, std::memory_order::relaxed);
+            }
             return;
         }
         for (const auto& [id, block] : *_blocks) {
+            auto* data = column(block);
             for (std::size_t i = 0; i < _size; i++) {
-                block.meta.type->destruct(_buffer + block.offset + i * block.meta.type->size);
+                block.meta.type->destruct(data + i * block.meta.type->size);
+            }
+            if (block.out_of_line) {
+                detail::slab_pool::get().deallocate(data, _out_of_line_capacity * block.meta.type->size);
             }
         }
-        delete reinterpret_cast<chunk_buffer*>(_buffer);
+        delete reinterpret_cast<chunk_buffer*>(buffer);
     }
 
     /// @brief Emplace back components into blocks
     ///
     /// @tparam Args Parameter pack
     /// @param ent Entity to emplace
-    /// @param args component arguments
-    template<component... Args>
+    /// @param args component values or in_place_t arguments
+    template<component_argument... Args>
     void emplace_back(entity ent, Args&&... args) {
         assert((!full()) && "Chunk is full, cannot add more entities");
+        reserve_out_of_line(_size + 1);
         std::construct_at(ptr_unchecked<entity>(size()), ent);
-        (..., std::construct_at(ptr_mut<Args>(size()), std::forward<Args>(args)));
+        (..., detail::construct_component(ptr_mut<constructed_component_t<Args>>(size()), std::forward<Args>(args)));
         _size++;
+        touch();
+    }
+
+    /// @brief Append rows copying components as raw bytes from columns. All components of the chunk must be trivially
+    /// copyable.
+    ///
+    /// @param entities Entities of the appended rows, at most max_size() - size()
+    /// @param source Function returning the first byte of the source column of a component_meta for these rows
+    void append_raw(std::span<const entity> entities, auto&& source) {
+        assert((_size + entities.size() <= _max_size) && "Chunk can not hold that many entities");
+        const auto count = entities.size();
+        while (_out_of_line && _out_of_line_capacity < _size + count) {
+            reserve_out_of_line(_size + count);
+        }
+        for (const auto& [id, block] : *_blocks) {
+            const auto* type = block.meta.type;
+            auto* data = column(block) + _size * type->size;
+            if (id == component_meta::of<entity>().id) {
+                std::uninitialized_copy(entities.begin(), entities.end(), reinterpret_cast<entity*>(data));
+            } else {
+                assert(type->trivially_copyable && "Raw bytes can only be copied into trivially copyable components");
+                std::memcpy(data, source(block.meta), count * type->size);
+            }
+        }
+        _size += count;
+        touch();
     }
 
     /// @brief Remove back elements from blocks
@@ -115,6 +257,8 @@ public:
         assert((!empty()) && "Chunk is empty, cannot pop out any entity");
         _size--;
         destroy_at(_size);
+        shrink_out_of_line();
+        touch();
     }
 
     /// @brief Swap end removes a components in blocks at position index and swaps it with the last element from
@@ -126,7 +270,7 @@ public:
     /// @return std::optional<entity>
     auto swap_erase(std::size_t index, chunk& other) noexcept -> std::optional<entity> {
         assert((index < _size) && "Entity index exceeds chunk size");
-        if (size() == 1 || index == _size - 1) {
+        if (this == &other && index == _size - 1) {
             pop_back();
             return std::nullopt;
         }
@@ -136,13 +280,210 @@ public:
         for (const auto& [id, block] : *_blocks) {
             auto other_block = other._blocks->find(id)->second;
             const auto* type = block.meta.type;
-            auto* ptr = other._buffer + other_block.offset + other_chunk_index * type->size;
-            type->move_assign(_buffer + block.offset + index * type->size, ptr);
+            auto* ptr = other.column(other_block) + other_chunk_index * type->size;
+            type->move_assign(column(block) + index * type->size, ptr);
         }
+        touch();
         other.pop_back();
         return ent;
     }
 
+    /// @brief Replace components at position index with components moved out of other chunk at other_index. The
+    /// source entry is left in a moved-from state and is expected to be removed with truncate() afterwards.
+    ///
+    /// @param index Index to replace components at
+    /// @param other Other chunk
+    /// @param other_index Index in other chunk to move components from
+    /// @return entity Entity that has been moved
+    auto replace(std::size_t index, chunk& other, std::size_t other_index) noexcept -> entity {
+        assert((index < _size) && "Entity index exceeds chunk size");
+        assert((other_index < other._size) && "Entity index exceeds other chunk size");
+        for (const auto& [id, block] : *_blocks) {
+            auto other_block = other._blocks->find(id)->second;
+            const auto* type = block.meta.type;
+            auto* ptr = other.column(other_block) + other_index * type->size;
+            type->move_assign(column(block) + index * type->size, ptr);
+        }
+        touch();
+        return *ptr_unchecked<entity>(index);
+    }
+
+    /// @brief Destroy components at positions [new_size, size())
+    ///
+    /// @param new_size New size
+    void truncate(std::size_t new_size) noexcept {
+        assert((new_size <= _size) && "New size exceeds chunk size");
+        while (_size > new_size) {
+            _size--;
+            destroy_at(_size);
+        }
+        shrink_out_of_line();
+        touch();
+    }
+
+    /// @brief Destroy all components, block by block, skipping trivially destructible components
+    void clear() noexcept {
+        for (const auto& [id, block] : *_blocks) {
+            const auto* type = block.meta.type;
+            if (type->trivially_destructible) {
+                continue;
+            }
+            auto* data = column(block);
+            for (std::size_t i = 0; i < _size; i++) {
+                type->destruct(data + i * type->size);
+            }
+        }
+        _size = 0;
+        shrink_out_of_line();
+        touch();
+    }
+
+    /// @brief Compress the chunk in place and release its buffer. The chunk is decompressed transparently on the next
+    /// access to its components. Only chunks holding trivially copyable components are compressed, since components are
+    /// restored into a different buffer, and only when compression saves at least a quarter of the size.
+    ///
+    /// Must not be called concurrently with any other access to this chunk.
+    ///
+    /// @return true If the chunk has been compressed
+    auto compress() -> bool {
+        auto* buffer = _buffer.load(std::memory_order::relaxed);
+        if (buffer == nullptr || empty()) {
+            return false;
+        }
+
+        std::size_t uncompressed_bytes{};
+        for (const auto& [id, block] : *_blocks) {
+            if (!block.meta.type->trivially_copyable || block.out_of_line) {
+                return false;
+            }
+            uncompressed_bytes += _size * block.meta.type->size;
+        }
+
+        std::vector<std::byte> compressed;
+        compressed.reserve(uncompressed_bytes);
+        for (const auto& [id, block] : *_blocks) {
+            const auto* type = block.meta.type;
+            detail::delta_rle_codec::encode(buffer + block.offset, _size * type->size, type->size, compressed);
+            if (compressed.size() * 4 > uncompressed_bytes * 3) {
+                return false;
+            }
+        }
+        compressed.shrink_to_fit();
+
+        auto& stats = counters();
+        stats.compressed_chunks.fetch_add(1, std::memory_order::relaxed);
+        stats.compressions.fetch_add(1, std::memory_order::relaxed);
+        stats.uncompressed_bytes.fetch_add(uncompressed_bytes, std::memory_order::relaxed);
+        stats.compressed_bytes.fetch_add(compressed.size(), std::memory_order::relaxed);
+
+        _compressed = std::move(compressed);
+        _buffer.store(nullptr, std::memory_order::relaxed);
+        delete reinterpret_cast<chunk_buffer*>(buffer);
+        return true;
+    }
+
+    /// @brief Check if chunk is compressed
+    ///
+    /// @return true If the chunk is compressed
+    [[nodiscard]] auto compressed() const noexcept -> bool {
+        return _buffer.load(std::memory_order::acquire) == nullptr && !_compressed.empty();
+    }
+
+    /// @brief Check if the chunk has been decompressed by an access. Const access does not change the version, so this
+    /// is the only trace of reads of a compressed chunk.
+    ///
+    /// @return true If the chunk has been decompressed since it was compressed
+    [[nodiscard]] auto woken() const noexcept -> bool {
+        return _woken.load(std::memory_order::relaxed);
+    }
+
+    /// @brief Move components into the block layout this chunk refers to, after the archetype changed the order of its
+    /// blocks. Must not be called concurrently with any other access to this chunk.
+    ///
+    /// @param from Block layout the components are stored in now
+    void relayout(const blocks_type& from) {
+        auto* old_buffer = _buffer.load(std::memory_order::relaxed);
+        if (old_buffer == nullptr) {
+            // compressed in the previous layout
+            old_buffer = decompress(from);
+        }
+
+        auto* new_buffer = allocate_buffer();
+        if (auto node = _node.load(std::memory_order::relaxed); node != detail::numa::unknown_node) {
+            detail::numa::topology::get().bind(new_buffer, chunk_bytes, node);
+        }
+        for (const auto& [id, block] : from) {
+            const auto* type = block.meta.type;
+            auto* source = old_buffer + block.offset;
+            auto* destination = new_buffer + _blocks->at(id).offset;
+            if (block.out_of_line || type->trivially_copyable) {
+                // out of line blocks only hold the slab pointer
+                std::memcpy(destination, source, block.out_of_line ? sizeof(std::byte*) : _size * type->size);
+                continue;
+            }
+            for (std::size_t i = 0; i < _size; i++) {
+                type->move_construct(destination + i * type->size, source + i * type->size);
+                type->destruct(source + i * type->size);
+            }
+        }
+
+        _buffer.store(new_buffer, std::memory_order::release);
+        delete reinterpret_cast<chunk_buffer*>(old_buffer);
+        touch();
+    }
+
+    /// @brief Return the NUMA node chunk memory is placed on
+    ///
+    /// @return std::size_t Node or detail::numa::unknown_node when the chunk has not been placed
+    [[nodiscard]] auto node() const noexcept -> std::size_t {
+        return _node.load(std::memory_order::relaxed);
+    }
+
+    /// @brief Place chunk memory on the given NUMA node, pages already touched are moved. No-op on single node
+    /// machines.
+    ///
+    /// @param node NUMA node
+    void bind(std::size_t node) const noexcept {
+        const auto& topology = detail::numa::topology::get();
+        if (!topology.enabled() || node == detail::numa::unknown_node) {
+            return;
+        }
+        _node.store(node, std::memory_order::relaxed);
+        if (auto* buffer = _buffer.load(std::memory_order::acquire)) {
+            topology.bind(buffer, chunk_bytes, node);
+        }
+    }
+
+    /// @brief Report that the chunk is processed by a worker on the given NUMA node. Once the chunk is processed from
+    /// the same other node node_migration_threshold times in a row its memory is moved there.
+    ///
+    /// @param node NUMA node of the worker
+    void prefer_node(std::size_t node) const noexcept {
+        if (node == _node.load(std::memory_order::relaxed)) {
+            _node_misses.store(0, std::memory_order::relaxed);
+            return;
+        }
+        if (_node_misses.fetch_add(1, std::memory_order::relaxed) + 1 >= node_migration_threshold) {
+            _node_misses.store(0, std::memory_order::relaxed);
+            bind(node);
+        }
+    }
+
+    /// @brief Return compression statistics accumulated over all chunks
+    ///
+    /// @return compression_stats Statistics
+    [[nodiscard]] static auto compression_statistics() noexcept -> compression_stats {
+        const auto& stats = counters();
+        return compression_stats{
+            stats.compressed_chunks.load(std::memory_order::relaxed),
+            stats.compressions.load(std::memory_order::relaxed),
+            stats.uncompressed_bytes.load(std::memory_order::relaxed),
+            stats.compressed_bytes.load(std::memory_order::relaxed),
+            stats.stalls.load(std::memory_order::relaxed),
+            std::chrono::nanoseconds(stats.stall_time.load(std::memory_order::relaxed)),
+        };
+    }
+
     /// @brief Move components in blocks at position index into other_chunk
     ///
     /// @param index Index to move from
@@ -152,15 +493,17 @@ public:
         assert((index < _size) && "Entity index exceeds chunk size");
         assert((!other_chunk.full()) && "Other chunk is full, cannot move entity to it");
         const std::size_t other_chunk_index = other_chunk._size;
+        other_chunk.reserve_out_of_line(other_chunk_index + 1);
         for (const auto& [id, block] : *_blocks) {
             const auto* type = block.meta.type;
             if (!other_chunk._blocks->contains(id)) {
                 continue;
             }
-            auto* ptr = other_chunk._buffer + other_chunk._blocks->at(id).offset + other_chunk_index * type->size;
-            type->move_construct(ptr, _buffer + block.offset + index * type->size);
+            auto* ptr = other_chunk.column(other_chunk._blocks->at(id)) + other_chunk_index * type->size;
+            type->move_construct(ptr, column(block) + index * type->size);
         }
         other_chunk._size++;
+        other_chunk.touch();
         return other_chunk_index;
     }
 
@@ -173,17 +516,19 @@ public:
         assert((index < _size) && "Entity index exceeds chunk size");
         assert((!other_chunk.full()) && "Other chunk is full, cannot move entity to it");
         const std::size_t other_chunk_index = other_chunk._size;
+        other_chunk.reserve_out_of_line(other_chunk_index + 1);
         for (const auto& [id, block] : *_blocks) {
             const auto* type = block.meta.type;
             if (!other_chunk._blocks->contains(id)) {
                 continue;
             }
-            auto* ptr = other_chunk._buffer + other_chunk._blocks->at(id).offset + other_chunk_index * type->size;
+            auto* ptr = other_chunk.column(other_chunk._blocks->at(id)) + other_chunk_index * type->size;
             if (type->copy_construct) {
-                type->copy_construct(ptr, _buffer + block.offset + index * type->size);
+                type->copy_construct(ptr, column(block) + index * type->size);
             }
         }
         other_chunk._size++;
+        other_chunk.touch();
         return other_chunk_index;
     }
 
@@ -191,6 +536,7 @@ public:
     /// @param index Index of an entity
     /// @param func Func to apply to components
     constexpr void visit(std::size_t index, auto&& func) noexcept {
+        touch();
         visit_impl(*this, index, std::forward<decltype(func)>(func));
     }
 
@@ -201,6 +547,32 @@ public:
         visit_impl(*this, index, std::forward<decltype(func)>(func));
     }
 
+    /// @brief Visit component columns of the chunk, the visitor is called once per component with all of its rows
+    /// instead of once per component per entity
+    ///
+    /// @param func Func to apply to component_column of every component
+    constexpr void visit_columns(auto&& func) {
+        touch();
+        visit_columns_impl(*this, std::forward<decltype(func)>(func));
+    }
+
+    /// @brief Visit component columns of the chunk
+    ///
+    /// @param func Func to apply to const_component_column of every component
+    constexpr void visit_columns(auto&& func) const {
+        visit_columns_impl(*this, std::forward<decltype(func)>(func));
+    }
+
+    /// @brief Return entities stored in the chunk, in the order of rows of component columns
+    ///
+    /// @return std::span<const entity> Entities
+    [[nodiscard]] auto entities() const -> std::span<const entity> {
+        if (empty()) {
+            return {};
+        }
+        return { ptr_unchecked<entity>(0), _size };
+    }
+
     /// @brief Give a const pointer to a component T at index
     ///
     /// @tparam T Component type
@@ -219,6 +591,7 @@ public:
     template<component T>
     inline auto ptr_mut(std::size_t index) -> T* {
         static_assert(!std::is_same_v<T, entity>, "Cannot give a mutable pointer/reference to the entity");
+        touch();
         return ptr_unchecked_impl<T*>(*this, index);
     }
 
@@ -252,6 +625,20 @@ public:
         return size() == 0;
     }
 
+    /// @brief Return change version. The version changes whenever entities are added or removed or components are
+    /// accessed mutably after the previous call, a new chunk never repeats the version of a removed one.
+    ///
+    /// @return std::uint64_t Version
+    [[nodiscard]] auto version() const noexcept -> std::uint64_t {
+        auto version = _version.load(std::memory_order::relaxed);
+        // accesses stamp the current epoch, start a new one so that accesses after this call stamp a different version
+        auto current = epoch().load(std::memory_order::relaxed);
+        if (current == version) {
+            epoch().compare_exchange_strong(current, current + 1, std::memory_order::relaxed);
+        }
+        return version;
+    }
+
 private:
     friend class base_registry;
 
@@ -265,11 +652,25 @@ private:
             *self._blocks | detail::views::drop(1)) // skip first block - it's an entity handle
         {
             const auto* type = block.meta.type;
-            ptr_t ptr = self._buffer + block.offset + index * type->size;
+            ptr_t ptr = self.column(block) + index * type->size;
             func(block.meta, ptr);
         }
     }
 
+    constexpr static void visit_columns_impl(auto&& self, auto&& func) {
+        constexpr auto is_const = std::is_const_v<std::remove_reference_t<decltype(self)>>;
+        using column_t = std::conditional_t<is_const, const_component_column, component_column>;
+
+        if (self._size == 0) {
+            return;
+        }
+        for (const auto& [id, block] :
+            *self._blocks | detail::views::drop(1)) // skip first block - it's an entity handle
+        {
+            func(column_t{ block.meta, self.column(block), block.meta.type->size, self._size });
+        }
+    }
+
     template<component T>
     [[nodiscard]] constexpr auto ptr_unchecked(std::size_t index) -> T* {
         return ptr_unchecked_impl<T*>(*this, index);
@@ -284,23 +685,167 @@ private:
     [[nodiscard]] static inline auto ptr_unchecked_impl(auto&& self, std::size_t index) -> P {
         using component_type = std::remove_const_t<std::remove_pointer_t<P>>;
         const auto& block = self.get_block(component_id::value<component_type>);
-        return (reinterpret_cast<P>(self._buffer + block.offset) + index);
+        return (reinterpret_cast<P>(self.column(block)) + index);
     }
 
     [[nodiscard]] auto get_block(component_id_t id) const -> const block_metadata& {
         return _blocks->at(id);
     }
 
+    static auto allocate_buffer() -> std::byte* {
+        return (new chunk_buffer)->data;
+    }
+
+    // Returns the beginning of the block, the slab for out of line blocks
+    [[nodiscard]] auto column(const block_metadata& block) const -> std::byte* {
+        auto* data = buffer() + block.offset;
+        if (block.out_of_line) [[unlikely]] {
+            std::byte* slab{};
+            std::memcpy(&slab, data, sizeof(slab));
+            return slab;
+        }
+        return data;
+    }
+
+    void set_slab(const block_metadata& block, std::byte* slab) noexcept {
+        std::memcpy(buffer() + block.offset, &slab, sizeof(slab));
+    }
+
+    // Grows out of line columns geometrically to hold at least size components
+    void reserve_out_of_line(std::size_t size) {
+        if (!_out_of_line || size <= _out_of_line_capacity) [[likely]] {
+            return;
+        }
+        auto capacity = std::max(_out_of_line_capacity * 2, out_of_line_initial_capacity);
+        reallocate_out_of_line(std::min(capacity, _max_size));
+    }
+
+    // Shrinks out of line columns once they are used by a quarter, keeping slabs compact after mass removals
+    void shrink_out_of_line() noexcept {
+        if (!_out_of_line || _out_of_line_capacity <= out_of_line_initial_capacity
+            || _size > _out_of_line_capacity / 4) [[likely]] {
+            return;
+        }
+        try {
+            reallocate_out_of_line(std::max(_size * 2, out_of_line_initial_capacity));
+        } catch (const std::bad_alloc&) {
+            // keep the larger slabs
+        }
+    }
+
+    void reallocate_out_of_line(std::size_t capacity) {
+        auto& pool = detail::slab_pool::get();
+        for (const auto& [id, block] : *_blocks) {
+            if (!block.out_of_line) {
+                continue;
+            }
+            const auto* type = block.meta.type;
+            auto* old_slab = column(block);
+            auto* new_slab = pool.allocate(capacity * type->size);
+            for (std::size_t i = 0; i < _size; i++) {
+                type->move_construct(new_slab + i * type->size, old_slab + i * type->size);
+                type->destruct(old_slab + i * type->size);
+            }
+            pool.deallocate(old_slab, _out_of_line_capacity * type->size);
+            set_slab(block, new_slab);
+        }
+        _out_of_line_capacity = capacity;
+    }
+
+    // Returns the buffer, decompressing the chunk first if it has been compressed. Readers of the same chunk may run in
+    // parallel, so decompression is serialized and published with release semantics.
+    [[nodiscard]] auto buffer() const -> std::byte* {
+        auto* buffer = _buffer.load(std::memory_order::acquire);
+        if (buffer != nullptr) [[likely]] {
+            return buffer;
+        }
+        return decompress(*_blocks);
+    }
+
+    auto decompress(const blocks_type& blocks) const -> std::byte* {
+        static std::mutex decompression_mutex;
+        std::lock_guard lock(decompression_mutex);
+
+        auto* buffer = _buffer.load(std::memory_order::relaxed);
+        if (buffer != nullptr) {
+            return buffer;
+        }
+        assert((!_compressed.empty()) && "Accessing a moved-from chunk");
+
+        auto start = std::chrono::steady_clock::now();
+
+        buffer = allocate_buffer();
+        if (auto node = _node.load(std::memory_order::relaxed); node != detail::numa::unknown_node) {
+            detail::numa::topology::get().bind(buffer, chunk_bytes, node);
+        }
+        const auto* in = _compressed.data();
+        for (const auto& [id, block] : blocks) {
+            const auto* type = block.meta.type;
+            detail::delta_rle_codec::decode(in, buffer + block.offset, _size * type->size, type->size);
+        }
+        std::vector<std::byte>().swap(_compressed);
+        _woken.store(true, std::memory_order::relaxed);
+        _buffer.store(buffer, std::memory_order::release);
+
+        auto& stats = counters();
+        stats.compressed_chunks.fetch_sub(1, std::memory_order::relaxed);
+        stats.stalls.fetch_add(1, std::memory_order::relaxed);
+        stats.stall_time.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+            std::memory_order::relaxed);
+        return buffer;
+    }
+
+    struct compression_counters {
+        std::atomic<std::uint64_t> compressed_chunks{};
+        std::atomic<std::uint64_t> compressions{};
+        std::atomic<std::uint64_t> uncompressed_bytes{};
+        std::atomic<std::uint64_t> compressed_bytes{};
+        std::atomic<std::uint64_t> stalls{};
+        std::atomic<std::int64_t> stall_time{};
+    };
+
+    static auto counters() noexcept -> compression_counters& {
+        static compression_counters counters;
+        return counters;
+    }
+
     inline void destroy_at(std::size_t index) noexcept {
         for (const auto& [id, block] : *_blocks) {
-            block.meta.type->destruct(_buffer + block.offset + index * block.meta.type->size);
+            block.meta.type->destruct(column(block) + index * block.meta.type->size);
+        }
+    }
+
+    // Systems writing different components of the same chunk run concurrently, so they all stamp the current epoch
+    // instead of a value of their own, the chunk is written once per epoch and the epoch is only read
+    void touch() noexcept {
+        auto current = epoch().load(std::memory_order::relaxed);
+        if (_version.load(std::memory_order::relaxed) != current) {
+            _version.store(current, std::memory_order::relaxed);
         }
     }
 
-    std::byte* _buffer{};
+    // New chunks take a fresh epoch, which is above every version observed so far
+    static auto next_version() noexcept -> std::uint64_t {
+        return epoch().fetch_add(1, std::memory_order::relaxed) + 1;
+    }
+
+    static auto epoch() noexcept -> std::atomic<std::uint64_t>& {
+        static std::atomic<std::uint64_t> epoch{};
+        return epoch;
+    }
+
+    mutable std::atomic<std::byte*> _buffer{};
     std::size_t _size{};
     std::size_t _max_size{};
     const blocks_type* _blocks;
+    std::atomic<std::uint64_t> _version{};
+    mutable std::vector<std::byte> _compressed;
+    bool _out_of_line{};
+    std::size_t _out_of_line_capacity{};
+    mutable std::atomic<std::size_t> _node{ detail::numa::unknown_node };
+    mutable std::atomic<bool> _woken{};
+    mutable std::atomic<std::uint32_t> _node_misses{};
 };
 
 /// @brief Component fetch is a namespace for routines that figure out based on input component_reference how to fetch
@@ -458,6 +1003,32 @@ public:
         return iterator(_chunk, _chunk.size());
     }
 
+    /// @brief Return number of entities in the chunk
+    ///
+    /// @return std::size_t Size
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+        return _chunk.size();
+    }
+
+    /// @brief Report that the chunk is processed by a worker on the given NUMA node
+    ///
+    /// @param node NUMA node of the worker
+    void prefer_node(std::size_t node) const noexcept {
+        _chunk.prefer_node(node);
+    }
+
+    /// @brief Return components of type C stored in the chunk as a contiguous array
+    ///
+    /// @tparam C Component type
+    /// @return std::span<const C> Components
+    template<component C>
+    [[nodiscard]] auto column() const -> std::span<const C> {
+        if (_chunk.empty()) {
+            return {};
+        }
+        return std::span<const C>(component_fetch::fetch_pointer<const C&>(_chunk, 0), _chunk.size());
+    }
+
 private:
     chunk_type _chunk;
 };
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <co_ecs/access_profile.hpp>
+#include <co_ecs/registry.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace co_ecs {
+
+/// @brief Layout pass placing the columns that views iterate together next to each other in chunks, so a hot system
+/// reads a single stream instead of columns kilobytes apart. Works from the accesses recorded by access_profile,
+/// archetypes created while recording is on get the layout right away.
+///
+/// @code
+/// co_ecs::access_profile::enable(true);
+/// run_frames(100);
+///
+/// auto before = co_ecs::chunk_layout::statistics(registry).hit_rate();
+/// co_ecs::chunk_layout::optimize(registry);
+/// auto after = co_ecs::chunk_layout::statistics(registry).hit_rate();
+/// @endcode
+///
+/// @note Optimize moves components of every chunk it changes, it must not run concurrently with systems, call it in
+/// between frames.
+class chunk_layout {
+public:
+    /// @brief Reorder blocks of archetypes to match recorded accesses
+    ///
+    /// @param registry Registry
+    /// @return std::size_t Number of archetypes whose layout changed
+    static auto optimize(registry& registry) -> std::size_t {
+        auto accesses = access_profile::accesses();
+        if (accesses.empty()) {
+            return 0;
+        }
+
+        std::size_t changed{};
+        auto& archetypes = registry.archetypes();
+        for (std::size_t index = 0; index < archetypes.size(); index++) {
+            auto* archetype = archetypes.by_index(index);
+            auto order = access_profile::order(archetype->components(), accesses);
+            if (archetype->relayout(order)) {
+                changed++;
+            }
+        }
+        return changed;
+    }
+
+    /// @brief Count recorded accesses that read adjacent columns with the current layouts
+    ///
+    /// @param registry Registry
+    /// @return layout_stats Statistics
+    [[nodiscard]] static auto statistics(const registry& registry) -> layout_stats {
+        auto accesses = access_profile::accesses();
+
+        layout_stats stats;
+        const auto& archetypes = registry.archetypes();
+        for (std::size_t index = 0; index < archetypes.size(); index++) {
+            const auto* archetype = archetypes.by_index(index);
+            auto order = archetype->block_order();
+            for (const auto& access : accesses) {
+                if (!access_profile::contains_all(archetype->components(), access.components)) {
+                    continue;
+                }
+                stats.accesses += access.count;
+                if (contiguous(order, access.components)) {
+                    stats.contiguous += access.count;
+                }
+            }
+        }
+        return stats;
+    }
+
+private:
+    static auto contiguous(std::span<const component_id_t> order, std::span<const component_id_t> components) -> bool {
+        std::size_t first = order.size();
+        std::size_t last{};
+        for (auto id : components) {
+            auto position = static_cast<std::size_t>(std::ranges::find(order, id) - order.begin());
+            first = std::min(first, position);
+            last = std::max(last, position);
+        }
+        return last - first + 1 == components.size();
+    }
+};
+
+} // namespace co_ecs
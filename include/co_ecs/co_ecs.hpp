@@ -1,6 +1,15 @@
 #pragma once
 
+#include <co_ecs/access_profile.hpp>
+#include <co_ecs/aggregate.hpp>
+#include <co_ecs/chunk_layout.hpp>
+#include <co_ecs/columnar.hpp>
 #include <co_ecs/command.hpp>
+#include <co_ecs/command_log.hpp>
+#include <co_ecs/compression.hpp>
+#include <co_ecs/double_buffer.hpp>
+#include <co_ecs/journal.hpp>
 #include <co_ecs/registry.hpp>
+#include <co_ecs/system/pipeline.hpp>
 #include <co_ecs/system/schedule.hpp>
 #include <co_ecs/view.hpp>
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <co_ecs/archetype.hpp>
+#include <co_ecs/registry.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief Exception raised when columnar data can not be imported
+class columnar_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// @brief Bulk import and export of the entities of an archetype as whole component columns.
+///
+/// The layout is self-describing: a header with the number of rows, a schema with the name, size and alignment of
+/// every component and the offset of its column, followed by the columns. Every column is a contiguous array of
+/// components starting at an offset aligned to column_alignment, so a memory mapped file can be read in place. Only
+/// trivially copyable components are supported, they are written and read as raw bytes in the native byte order.
+/// Entity handles are not exported, importing creates new entities.
+///
+/// @code
+/// std::ofstream out("units.columns", std::ios::binary);
+/// co_ecs::columnar::save<position, velocity>(registry, out);
+///
+/// std::ifstream in("units.columns", std::ios::binary);
+/// auto entities = co_ecs::columnar::load<position, velocity>(other_registry, in);
+/// @endcode
+///
+/// @note Component names come from type_meta, data is exchanged between binaries built with the same compiler.
+class columnar {
+public:
+    /// @brief Alignment of column offsets
+    static constexpr std::size_t column_alignment = 64;
+
+    /// @brief Write all entities of an archetype, columns are streamed out chunk by chunk
+    ///
+    /// @param archetype Archetype
+    /// @param out Output stream
+    static void save(const archetype& archetype, std::ostream& out) {
+        std::vector<component_meta> metas(archetype.components().begin(), archetype.components().end());
+        write(out, archetype.size(), metas, [&](const component_meta& meta) {
+            for (const auto& chunk : archetype.chunks()) {
+                chunk.visit_columns([&](const_component_column column) {
+                    if (column.meta == meta) {
+                        out.write(static_cast<const char*>(column.data),
+                            static_cast<std::streamsize>(column.count * column.stride));
+                    }
+                });
+            }
+        });
+    }
+
+    /// @brief Write all entities of the archetype holding exactly components C
+    ///
+    /// @tparam C Component types
+    /// @param registry Registry
+    /// @param out Output stream
+    template<component... C>
+        requires(std::is_trivially_copyable_v<C> && ...)
+    static void save(const registry& registry, std::ostream& out) {
+        const auto components = component_meta_set::create<C...>();
+        const auto& archetypes = registry.archetypes();
+        for (std::size_t index = 0; index < archetypes.size(); index++) {
+            if (archetypes.by_index(index)->components() == components) {
+                save(*archetypes.by_index(index), out);
+                return;
+            }
+        }
+        std::vector<component_meta> metas(components.begin(), components.end());
+        write(out, 0, metas, [](const component_meta&) {});
+    }
+
+    /// @brief Create entities with components C from columnar data, the archetype is resolved once and chunks are
+    /// filled with memcpy directly from the columns
+    ///
+    /// @tparam C Component types, must match the schema
+    /// @param registry Registry
+    /// @param data Columnar data
+    /// @return std::vector<entity> Created entities, in the order of the rows
+    template<component... C>
+        requires(sizeof...(C) > 0 && (std::is_trivially_copyable_v<C> && ...))
+    static auto load(registry& registry, std::span<const std::byte> data) -> std::vector<entity> {
+        [[maybe_unused]] detail::unique_types<C...> uniqueness_check;
+
+        auto [rows, schema] = read_schema(data);
+        if (schema.size() != sizeof...(C)) {
+            throw columnar_error("columnar data holds a different number of components");
+        }
+        std::array offsets{ column_offset(schema, rows, data.size(), component_meta::of<C>())... };
+        std::array ids{ component_meta::of<C>().id... };
+
+        auto* archetype = registry._archetypes.template ensure_archetype<C...>();
+        return registry.create_raw(*archetype, rows, [&](const component_meta& meta) -> const std::byte* {
+            auto index = static_cast<std::size_t>(std::ranges::find(ids, meta.id) - ids.begin());
+            return data.data() + offsets[index];
+        });
+    }
+
+    /// @brief Create entities with components C from columnar data read from a stream
+    ///
+    /// @tparam C Component types, must match the schema
+    /// @param registry Registry
+    /// @param in Input stream
+    /// @return std::vector<entity> Created entities, in the order of the rows
+    template<component... C>
+        requires(sizeof...(C) > 0 && (std::is_trivially_copyable_v<C> && ...))
+    static auto load(registry& registry, std::istream& in) -> std::vector<entity> {
+        std::vector<char> bytes(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>{});
+        return load<C...>(registry, std::as_bytes(std::span(bytes)));
+    }
+
+private:
+    struct column_schema {
+        std::string_view name;
+        std::uint64_t size{};
+        std::uint64_t align{};
+        std::uint64_t offset{};
+    };
+
+    static constexpr std::array<char, 8> magic{ 'c', 'o', 'e', 'c', 's', 'c', 'o', 'l' };
+    static constexpr std::uint32_t version = 1;
+
+    static auto align_up(std::uint64_t offset) noexcept -> std::uint64_t {
+        return (offset + column_alignment - 1) / column_alignment * column_alignment;
+    }
+
+    static void write(std::ostream& out, std::size_t rows, std::span<const component_meta> metas, auto&& write_column) {
+        for (const auto& meta : metas) {
+            if (!meta.type->trivially_copyable) {
+                throw columnar_error("component " + std::string(meta.type->name) + " is not trivially copyable");
+            }
+        }
+
+        std::vector<std::byte> header;
+        auto put = [&](const auto& value) {
+            const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+            header.insert(header.end(), bytes, bytes + sizeof(value));
+        };
+        put(magic);
+        put(version);
+        put(static_cast<std::uint32_t>(metas.size()));
+        put(static_cast<std::uint64_t>(rows));
+
+        std::uint64_t header_size = header.size();
+        for (const auto& meta : metas) {
+            header_size += 3 * sizeof(std::uint64_t) + sizeof(std::uint32_t) + meta.type->name.size();
+        }
+        auto offset = header_size;
+        for (const auto& meta : metas) {
+            offset = align_up(offset);
+            put(static_cast<std::uint64_t>(meta.type->size));
+            put(static_cast<std::uint64_t>(meta.type->align));
+            put(offset);
+            put(static_cast<std::uint32_t>(meta.type->name.size()));
+            const auto* name = reinterpret_cast<const std::byte*>(meta.type->name.data());
+            header.insert(header.end(), name, name + meta.type->name.size());
+            offset += rows * meta.type->size;
+        }
+        out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+        static constexpr std::array<char, column_alignment> padding{};
+        offset = header_size;
+        for (const auto& meta : metas) {
+            auto aligned = align_up(offset);
+            out.write(padding.data(), static_cast<std::streamsize>(aligned - offset));
+            write_column(meta);
+            offset = aligned + rows * meta.type->size;
+        }
+        if (!out) {
+            throw columnar_error("failed to write columnar data");
+        }
+    }
+
+    static auto read_schema(std::span<const std::byte> data) -> std::pair<std::size_t, std::vector<column_schema>> {
+        std::size_t position{};
+        auto get = [&]<typename T>(T& value) {
+            if (data.size() - position < sizeof(T)) {
+                throw columnar_error("columnar data is truncated");
+            }
+            std::memcpy(&value, data.data() + position, sizeof(T));
+            position += sizeof(T);
+        };
+
+        std::array<char, 8> header_magic{};
+        std::uint32_t header_version{};
+        std::uint32_t columns{};
+        std::uint64_t rows{};
+        get(header_magic);
+        if (header_magic != magic) {
+            throw columnar_error("not columnar data");
+        }
+        get(header_version);
+        if (header_version != version) {
+            throw columnar_error("unsupported columnar data version");
+        }
+        get(columns);
+        get(rows);
+
+        std::vector<column_schema> schema(columns);
+        for (auto& column : schema) {
+            std::uint32_t name_size{};
+            get(column.size);
+            get(column.align);
+            get(column.offset);
+            get(name_size);
+            if (data.size() - position < name_size) {
+                throw columnar_error("columnar data is truncated");
+            }
+            column.name = std::string_view(reinterpret_cast<const char*>(data.data() + position), name_size);
+            position += name_size;
+        }
+        return { rows, std::move(schema) };
+    }
+
+    static auto column_offset(
+        std::span<const column_schema> schema, std::size_t rows, std::size_t data_size, const component_meta& meta)
+        -> std::size_t {
+        auto it = std::ranges::find(schema, meta.type->name, &column_schema::name);
+        if (it == schema.end()) {
+            throw columnar_error("columnar data has no column for " + std::string(meta.type->name));
+        }
+        if (it->size != meta.type->size || it->align != meta.type->align) {
+            throw columnar_error("column " + std::string(meta.type->name) + " has a different layout");
+        }
+        if (it->offset > data_size || (data_size - it->offset) / meta.type->size < rows) {
+            throw columnar_error("columnar data is truncated");
+        }
+        return static_cast<std::size_t>(it->offset);
+    }
+};
+
+} // namespace co_ecs
@@ -1,14 +1,23 @@
 #pragma once
 
+#include <co_ecs/command_log.hpp>
 #include <co_ecs/entity_ref.hpp>
 #include <co_ecs/registry.hpp>
+#include <co_ecs/system/access.hpp>
 
+#include <algorithm>
 #include <deque>
 #include <mutex>
 #include <variant>
 
 namespace co_ecs {
 
+/// @brief Order in which commands from thread local command buffers are played back on flush.
+enum class flush_order {
+    registration, ///< Buffers are played one by one in the order their threads first recorded a command.
+    deterministic ///< Commands of all buffers are merged by the order key of their writers, independent of threads.
+};
+
 /// @brief This class manages command buffers and facilitates command execution.
 /// @details Command buffer manages a list of commands to be executed on the registry.
 /// It has a thread local container for encoding incomming commands as well as a storage
@@ -24,19 +33,56 @@ public:
 
     /// @brief Flushes all commands in the command buffers to the given registry.
     /// @param registry Reference to the registry object to synchronize with.
-    static void flush(registry& registry) {
+    /// @param order Order in which commands of different buffers are played.
+    static void flush(registry& registry, flush_order order = flush_order::registration) {
         registry.sync();
 
         std::lock_guard lk{ _mutex };
+        deferred_index_updates index_batch{ registry };
+        if (order == flush_order::deterministic) {
+            play_commands_ordered(registry);
+            return;
+        }
+
         for (auto* command_buffer : _command_buffers) {
             command_buffer->play_commands(registry);
         }
     }
 
+    /// @brief Returns the components affected by commands recorded since the last flush.
+    ///
+    /// Creating an entity, setting or removing a component writes the component types involved, destroying or cloning
+    /// an entity writes the whole registry. Must not be called while commands are being recorded.
+    ///
+    /// @return Access pattern of pending commands, empty when there are no pending commands.
+    [[nodiscard]] static auto pending() -> access_pattern_t {
+        std::lock_guard lk{ _mutex };
+        access_pattern_t affected;
+        for (auto* command_buffer : _command_buffers) {
+            affected &= command_buffer->_affected;
+        }
+        return affected;
+    }
+
+    /// @brief Installs a log that records every command played by flush, pass nullptr to stop recording.
+    ///
+    /// @param log Command log, must outlive the recording.
+    static void set_log(command_log* log) {
+        std::lock_guard lk{ _mutex };
+        _log = log;
+    }
+
+    /// @brief Unregisters the command buffer when its thread exits.
+    ~command_buffer() {
+        std::lock_guard lk{ _mutex };
+        std::erase(_command_buffers, this);
+    }
+
 private:
     static inline std::mutex _mutex; ///< Mutex to synchronize access to the command buffers vector.
     static inline std::vector<command_buffer*>
         _command_buffers; ///< Vector containing all thread-local command buffers.
+    static inline command_log* _log{}; ///< Log recording played commands, if any.
 
     friend class command_writer;
     friend class command_entity_ref;
@@ -47,8 +93,12 @@ private:
     }
 
     template<typename T>
-    void push(auto&&... args) {
-        _commands.emplace_back(T{ std::forward<decltype(args)>(args)... });
+    void push(std::uint64_t order, auto&&... args) {
+        _commands.emplace_back(ordered_command{ order, T{ std::forward<decltype(args)>(args)... } });
+    }
+
+    void affect(const access_pattern_t& access) {
+        _affected &= access;
     }
 
     auto staging() noexcept -> registry& {
@@ -60,7 +110,43 @@ private:
             auto command = std::move(_commands.front());
             _commands.pop_front();
 
-            std::visit([&](auto&& cmd) { cmd.execute(_staging, registry); }, command);
+            std::visit(
+                [&](auto&& cmd) {
+                    if (_log) {
+                        cmd.record(*_log, _staging);
+                    }
+                    cmd.execute(_staging, registry);
+                },
+                command.cmd);
+        }
+        _affected = {};
+    }
+
+    static void play_commands_ordered(registry& registry) {
+        std::vector<std::pair<command_buffer*, ordered_command*>> commands;
+        for (auto* command_buffer : _command_buffers) {
+            for (auto& command : command_buffer->_commands) {
+                commands.emplace_back(command_buffer, &command);
+            }
+        }
+
+        // stable sort keeps the recording order of commands sharing the same writer
+        std::ranges::stable_sort(commands, {}, [](const auto& entry) { return entry.second->order; });
+
+        for (auto [command_buffer, command] : commands) {
+            std::visit(
+                [&](auto&& cmd) {
+                    if (_log) {
+                        cmd.record(*_log, command_buffer->_staging);
+                    }
+                    cmd.execute(command_buffer->_staging, registry);
+                },
+                command->cmd);
+        }
+
+        for (auto* command_buffer : _command_buffers) {
+            command_buffer->_commands.clear();
+            command_buffer->_affected = {};
         }
     }
 
@@ -73,6 +159,10 @@ private:
             staging.get_entity(_staging_entity).move(destination, _reserved);
         }
 
+        void record(command_log& log, const registry& staging) const {
+            log.create(staging, _staging_entity, _reserved.get_entity());
+        }
+
     private:
         entity _staging_entity;
         placeholder_entity _reserved;
@@ -87,6 +177,10 @@ private:
             destination.get_entity(_entity).clone(_reserved);
         }
 
+        void record(command_log& log, [[maybe_unused]] const registry& staging) const {
+            log.clone(_entity, _reserved.get_entity());
+        }
+
     private:
         entity _entity;
         placeholder_entity _reserved;
@@ -104,6 +198,12 @@ private:
             _set_fn(staging, _staging_entity, destination, _destination_entity);
         }
 
+        void record(command_log& log, const registry& staging) const {
+            // the staging entity holds only the component being set
+            staging.visit(_staging_entity,
+                [&](component_meta meta, const void* ptr) { log.set(meta, ptr, _destination_entity); });
+        }
+
     private:
         entity _staging_entity;
         entity _destination_entity;
@@ -114,15 +214,21 @@ private:
     public:
         using remove_fn_t = std::function<void(registry&, entity)>;
 
-        command_remove(entity ent, remove_fn_t fn) : _entity(ent), _remove_fn(std::move(fn)) {
+        command_remove(entity ent, component_meta meta, remove_fn_t fn) :
+            _entity(ent), _meta(meta), _remove_fn(std::move(fn)) {
         }
 
         void execute(registry& staging, registry& destination) {
             _remove_fn(destination, _entity);
         }
 
+        void record(command_log& log, [[maybe_unused]] const registry& staging) const {
+            log.remove(_meta, _entity);
+        }
+
     private:
         entity _entity;
+        component_meta _meta;
         remove_fn_t _remove_fn;
     };
 
@@ -135,6 +241,10 @@ private:
             registry.get_entity(_entity).destroy();
         }
 
+        void record(command_log& log, [[maybe_unused]] const registry& staging) const {
+            log.destroy(_entity);
+        }
+
     private:
         entity _entity;
     };
@@ -146,9 +256,16 @@ private:
         command_remove,
         command_destroy>;
 
+    /// @brief Command along with the order key of the writer that recorded it.
+    struct ordered_command {
+        std::uint64_t order;
+        command cmd;
+    };
+
 private:
-    registry _staging;             ///< Staging registry for intermediate command processing.
-    std::deque<command> _commands; ///< Deque containing the commands to be executed.
+    registry _staging;                     ///< Staging registry for intermediate command processing.
+    std::deque<ordered_command> _commands; ///< Deque containing the commands to be executed.
+    access_pattern_t _affected;            ///< Components affected by the commands to be executed.
 };
 
 
@@ -165,7 +282,9 @@ public:
     template<component C, typename... Args>
     auto set(Args&&... args) -> command_entity_ref& {
         auto staging_entity = _commands.staging().template create<C>(C{ std::forward<Args>(args)... });
-        _commands.push<command_buffer::command_set>(staging_entity,
+        _commands.affect(access_pattern_t(access_type::write, component_meta::of<C>()));
+        _commands.push<command_buffer::command_set>(_order,
+            staging_entity,
             _entity,
             [](auto& staging_registry, auto staging_entity, auto& dest_registry, auto dest_entity) {
                 dest_registry.get_entity(dest_entity)
@@ -179,22 +298,27 @@ public:
     /// @return A reference to the command_entity_ref for chaining.
     template<component C>
     auto remove() -> command_entity_ref& {
-        _commands.push<command_buffer::command_remove>(
-            _entity, [](auto& registry, auto entity) { registry.get_entity(entity).template remove<C>(); });
+        _commands.affect(access_pattern_t(access_type::write, component_meta::of<C>()));
+        _commands.push<command_buffer::command_remove>(_order,
+            _entity,
+            component_meta::of<C>(),
+            [](auto& registry, auto entity) { registry.get_entity(entity).template remove<C>(); });
         return *this;
     }
 
     /// @brief Destroys the entity.
     void destroy() {
-        _commands.push<command_buffer::command_destroy>(_entity);
+        _commands.affect(access_pattern_t(access_type::write));
+        _commands.push<command_buffer::command_destroy>(_order, _entity);
     }
 
     /// @brief Clones the entity.
     /// @return A reference to the cloned command_entity_ref.
     auto clone() const -> command_entity_ref {
         auto entity = _registry.reserve();
-        _commands.push<command_buffer::command_clone>(_entity, entity);
-        return command_entity_ref{ _commands, _registry, entity.get_entity() };
+        _commands.affect(access_pattern_t(access_type::write));
+        _commands.push<command_buffer::command_clone>(_order, _entity, entity);
+        return command_entity_ref{ _commands, _registry, entity.get_entity(), _order };
     }
 
     /// @brief Conversion operator to entity.
@@ -206,14 +330,15 @@ public:
 private:
     friend class command_writer;
 
-    command_entity_ref(command_buffer& commands, registry& registry, entity entity) :
-        _commands(commands), _registry(registry), _entity(entity) {
+    command_entity_ref(command_buffer& commands, registry& registry, entity entity, std::uint64_t order) :
+        _commands(commands), _registry(registry), _entity(entity), _order(order) {
     }
 
 private:
     command_buffer& _commands; ///< Reference to the command buffer object.
     registry& _registry;       ///< Reference to the registry object.
     entity _entity;            ///< The entity being referenced.
+    std::uint64_t _order;      ///< Order key of the writer that created this reference.
 };
 
 /// @brief This class is responsible for writing commands to a command_buffer.
@@ -236,14 +361,15 @@ class command_writer {
 public:
     /// @brief Constructs a command_writer with a given registry.
     /// @param reg Reference to a registry object.
-    command_writer(registry& reg) : _reg(reg), _cmds(command_buffer::get()) {
+    /// @param order Order key of the commands recorded by this writer, used by a deterministic flush.
+    command_writer(registry& reg, std::uint64_t order = 0) : _reg(reg), _cmds(command_buffer::get()), _order(order) {
     }
 
     /// @brief Retrieves a reference to a command entity.
     /// @param ent The entity to retrieve.
     /// @return A reference to the command entity.
     auto get_entity(entity ent) -> command_entity_ref {
-        return command_entity_ref{ _cmds, _reg, ent };
+        return command_entity_ref{ _cmds, _reg, ent, _order };
     }
 
     /// @brief Creates a new entity with the given components.
@@ -254,19 +380,22 @@ public:
     auto create(Args&&... args) -> command_entity_ref {
         auto entity = _reg.reserve();
         auto staging_entity = _cmds.staging().template create<Args...>(std::forward<Args>(args)...);
-        _cmds.push<command_buffer::command_create>(staging_entity, entity);
-        return command_entity_ref{ _cmds, _reg, entity.get_entity() };
+        (_cmds.affect(access_pattern_t(access_type::write, component_meta::of<Args>())), ...);
+        _cmds.push<command_buffer::command_create>(_order, staging_entity, entity);
+        return command_entity_ref{ _cmds, _reg, entity.get_entity(), _order };
     }
 
     /// @brief Destroys an existing entity.
     /// @param ent The entity to be destroyed.
     void destroy(entity ent) {
-        _cmds.push<command_buffer::command_destroy>(ent);
+        _cmds.affect(access_pattern_t(access_type::write));
+        _cmds.push<command_buffer::command_destroy>(_order, ent);
     };
 
 private:
     registry& _reg;        ///< Reference to the registry object.
     command_buffer& _cmds; ///< Reference to the command buffer object.
+    std::uint64_t _order;  ///< Order key of the recorded commands.
 };
 
 
@@ -0,0 +1,574 @@
+#pragma once
+
+#include <co_ecs/detail/hash_map.hpp>
+#include <co_ecs/registry.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief Converts components of one type to bytes and back, used by command logs.
+struct component_serializer {
+    /// @brief Function appending the bytes of a component to a buffer
+    using write_func = std::function<void(const void*, std::vector<std::byte>&)>;
+
+    /// @brief Function reading a component from bytes and setting it to an entity
+    using read_func = std::function<void(std::span<const std::byte>, registry&, entity)>;
+
+    /// @brief Function removing the component from an entity
+    using remove_func = std::function<void(registry&, entity)>;
+
+    write_func write;
+    read_func read;
+    remove_func remove;
+    std::size_t raw_size{}; ///< Size of a component copied as raw bytes, 0 when written by write
+};
+
+/// @brief Global table of component serializers, looked up by component ID when recording and by component name when
+/// replaying, since component IDs depend on the order components are first used in a process.
+///
+/// Trivially copyable components are serialized as raw bytes, other components need custom functions.
+///
+/// @code
+/// co_ecs::component_serializers::add<position>();
+/// co_ecs::component_serializers::add<name_tag>(
+///     [](const name_tag& tag, std::vector<std::byte>& out) { ... },
+///     [](std::span<const std::byte> bytes) -> name_tag { ... });
+/// @endcode
+class component_serializers {
+public:
+    /// @brief Register a raw bytes serializer for a trivially copyable component
+    ///
+    /// @tparam C Component type
+    template<component C>
+        requires std::is_trivially_copyable_v<C> && std::is_default_constructible_v<C>
+    static void add() {
+        add<C>([](const C& value, std::vector<std::byte>& out) {
+            const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(C));
+        },
+            [](std::span<const std::byte> bytes) -> C {
+                C value{};
+                std::memcpy(&value, bytes.data(), std::min(bytes.size(), sizeof(C)));
+                return value;
+            });
+
+        // let logs copy the bytes directly instead of calling write
+        auto& table = instance();
+        std::lock_guard lock(table._mutex);
+        table._serializers.at(component_meta::of<C>().id)->raw_size = sizeof(C);
+    }
+
+    /// @brief Register a serializer for a component
+    ///
+    /// @tparam C Component type
+    /// @param write Function appending bytes of a component to a buffer
+    /// @param read Function constructing a component from bytes written by write
+    template<component C>
+    static void add(std::function<void(const C&, std::vector<std::byte>&)> write,
+        std::function<C(std::span<const std::byte>)> read) {
+        auto meta = component_meta::of<C>();
+        component_serializer serializer{
+            [write = std::move(write)](const void* ptr, std::vector<std::byte>& out) {
+                write(*static_cast<const C*>(ptr), out);
+            },
+            [read = std::move(read)](std::span<const std::byte> bytes, registry& registry, entity ent) {
+                registry.get_entity(ent).template set<C>(read(bytes));
+            },
+            [](registry& registry, entity ent) { registry.get_entity(ent).template remove<C>(); },
+        };
+
+        auto& table = instance();
+        std::lock_guard lock(table._mutex);
+        table._by_name.insert_or_assign({ std::string(meta.type->name), meta.id });
+        if (auto it = table._serializers.find(meta.id); it != table._serializers.end()) {
+            // logs keep pointers to serializers, replace in place
+            *it->second = std::move(serializer);
+            return;
+        }
+        table._serializers.insert({ meta.id, &table._storage.emplace_back(std::move(serializer)) });
+    }
+
+    /// @brief Find serializer of a component by ID
+    ///
+    /// @param id Component ID
+    /// @return const component_serializer* Serializer or nullptr
+    [[nodiscard]] static auto find(component_id_t id) -> const component_serializer* {
+        auto& table = instance();
+        std::lock_guard lock(table._mutex);
+        auto it = table._serializers.find(id);
+        return it != table._serializers.end() ? it->second : nullptr;
+    }
+
+    /// @brief Find serializer of a component by type name
+    ///
+    /// @param name Component type name
+    /// @return const component_serializer* Serializer or nullptr
+    [[nodiscard]] static auto find(const std::string& name) -> const component_serializer* {
+        auto& table = instance();
+        std::unique_lock lock(table._mutex);
+        auto it = table._by_name.find(name);
+        if (it == table._by_name.end()) {
+            return nullptr;
+        }
+        auto id = it->second;
+        lock.unlock();
+        return find(id);
+    }
+
+private:
+    static auto instance() -> component_serializers& {
+        static component_serializers table;
+        return table;
+    }
+
+    std::mutex _mutex;
+    std::deque<component_serializer> _storage;
+    detail::hash_map<component_id_t, component_serializer*> _serializers;
+    detail::hash_map<std::string, component_id_t> _by_name;
+};
+
+/// @brief Exception raised when a command log can not be replayed
+class replay_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// @brief Compact binary log of the commands played by command_buffer::flush together with per frame inputs.
+///
+/// Install a log with command_buffer::set_log() and call begin_frame() before every frame, every flush then appends
+/// the commands it plays. Components are written with the serializers registered in component_serializers and named
+/// by their type names, so a log recorded by one build can be replayed by another one of the same code. Replay the
+/// log with command_log_player against a registry in the state the recording started from.
+///
+/// @code
+/// co_ecs::command_log log;
+/// co_ecs::command_buffer::set_log(&log);
+///
+/// while (running) {
+///     log.begin_frame(std::as_bytes(std::span{ &input, 1 }));
+///     executor->run_once();
+/// }
+///
+/// std::ofstream file("session.log", std::ios::binary);
+/// log.save(file);
+/// @endcode
+class command_log {
+public:
+    /// @brief Record kinds
+    enum class record : std::uint8_t {
+        frame = 1,     ///< Frame start with inputs
+        component = 2, ///< Component name definition
+        create = 3,    ///< Entity creation with components
+        clone = 4,     ///< Entity clone
+        set = 5,       ///< Component set
+        remove = 6,    ///< Component removal
+        destroy = 7,   ///< Entity destruction
+    };
+
+    /// @brief Marker of a component without a registered serializer
+    static constexpr std::uint32_t unserializable = std::numeric_limits<std::uint32_t>::max();
+
+    /// @brief Construct an empty log
+    command_log() : _bytes(magic.begin(), magic.end()), _size(magic.size()) {
+    }
+
+    /// @brief Start a new frame
+    ///
+    /// @param inputs Frame inputs stored along with the frame
+    void begin_frame(std::span<const std::byte> inputs = {}) {
+        put(record::frame, _frames++, static_cast<std::uint32_t>(inputs.size()));
+        put_bytes(inputs.data(), inputs.size());
+    }
+
+    /// @brief Get number of frames recorded
+    ///
+    /// @return std::uint64_t Number of frames
+    [[nodiscard]] auto frames() const noexcept -> std::uint64_t {
+        return _frames;
+    }
+
+    /// @brief Get encoded log, or the part recorded since the last drain()
+    ///
+    /// @return std::span<const std::byte> Bytes
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        return { _bytes.data(), _size };
+    }
+
+    /// @brief Write the log to a stream
+    ///
+    /// @param out Output stream
+    void save(std::ostream& out) const {
+        out.write(reinterpret_cast<const char*>(_bytes.data()), static_cast<std::streamsize>(_size));
+    }
+
+    /// @brief Append the bytes recorded since the last drain to a stream and reuse the buffer for the next ones, keeps
+    /// the memory held by a long recording bounded. The stream receives the same bytes save() would have written.
+    ///
+    /// @param out Output stream
+    void drain(std::ostream& out) {
+        save(out);
+        _size = 0;
+    }
+
+    /// @brief Append the bytes recorded since the last drain to a buffer and reuse the log buffer for the next ones
+    ///
+    /// @param out Output buffer
+    void drain(std::vector<std::byte>& out) {
+        auto bytes = this->bytes();
+        out.insert(out.end(), bytes.begin(), bytes.end());
+        _size = 0;
+    }
+
+    /// @brief Read a log written by save()
+    ///
+    /// @param in Input stream
+    /// @return std::vector<std::byte> Bytes to replay
+    [[nodiscard]] static auto load(std::istream& in) -> std::vector<std::byte> {
+        std::vector<std::byte> bytes;
+        char buffer[4096];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            const auto* begin = reinterpret_cast<const std::byte*>(buffer);
+            bytes.insert(bytes.end(), begin, begin + in.gcount());
+        }
+        return bytes;
+    }
+
+    /// @brief Record entity creation, components are read from the staging entity
+    ///
+    /// @param staging Staging registry
+    /// @param staging_entity Entity holding the components
+    /// @param ent Created entity
+    void create(const registry& staging, entity staging_entity, entity ent) {
+        _record_start = _size;
+        put(record::create, ent.id(), ent.generation(), std::uint16_t{});
+        std::uint16_t count{};
+        staging.visit(staging_entity, [&](component_meta meta, const void* ptr) {
+            put_component(meta, ptr);
+            count++;
+        });
+        // definitions of new components may have moved the record
+        auto count_offset = _record_start + sizeof(record) + sizeof(typename entity::id_t)
+                            + sizeof(typename entity::generation_t);
+        std::memcpy(_bytes.data() + count_offset, &count, sizeof(count));
+    }
+
+    /// @brief Record entity clone
+    ///
+    /// @param ent Source entity
+    /// @param clone Cloned entity
+    void clone(entity ent, entity clone) {
+        put(record::clone, ent.id(), ent.generation(), clone.id(), clone.generation());
+    }
+
+    /// @brief Record component set
+    ///
+    /// @param meta Component
+    /// @param ptr Component value
+    /// @param ent Entity
+    void set(component_meta meta, const void* ptr, entity ent) {
+        _record_start = _size;
+        put(record::set, ent.id(), ent.generation());
+        put_component(meta, ptr);
+    }
+
+    /// @brief Record component removal
+    ///
+    /// @param meta Component
+    /// @param ent Entity
+    void remove(component_meta meta, entity ent) {
+        _record_start = _size;
+        put(record::remove, ent.id(), ent.generation());
+        put(local_id(meta));
+    }
+
+    /// @brief Record entity destruction
+    ///
+    /// @param ent Entity
+    void destroy(entity ent) {
+        put(record::destroy, ent.id(), ent.generation());
+    }
+
+private:
+    static constexpr std::array<std::byte, 8> magic{ std::byte{ 'c' },
+        std::byte{ 'o' },
+        std::byte{ 'e' },
+        std::byte{ 'c' },
+        std::byte{ 's' },
+        std::byte{ 'l' },
+        std::byte{ 'o' },
+        std::byte{ 'g' } };
+
+    friend class command_log_player;
+
+    // recording runs for every played command, the buffer is grown geometrically ahead of the recorded size so
+    // appending a record is a bounds check and a few copies
+    auto grow(std::size_t size) -> std::byte* {
+        if (_size + size > _bytes.size()) [[unlikely]] {
+            _bytes.resize(std::max(_size + size, _bytes.size() * 2));
+        }
+        auto* out = _bytes.data() + _size;
+        _size += size;
+        return out;
+    }
+
+    void put(const auto&... values) {
+        static_assert((std::is_trivially_copyable_v<std::decay_t<decltype(values)>> && ...));
+        auto* out = grow((sizeof(values) + ...));
+        ((std::memcpy(out, &values, sizeof(values)), out += sizeof(values)), ...);
+    }
+
+    void put_bytes(const void* ptr, std::size_t size) {
+        if (size != 0) {
+            std::memcpy(grow(size), ptr, size);
+        }
+    }
+
+    void put_component(component_meta meta, const void* ptr) {
+        auto id = local_id(meta);
+        auto*& serializer = _serializers[id];
+        if (!serializer) {
+            // registered after the component was first logged
+            serializer = component_serializers::find(meta.id);
+        }
+        if (!serializer) {
+            put(id, unserializable);
+            return;
+        }
+        if (serializer->raw_size != 0) {
+            // ID, size and bytes in one go, this is the hot path of recording
+            auto size = static_cast<std::uint32_t>(serializer->raw_size);
+            auto* out = grow(sizeof(id) + sizeof(size) + size);
+            std::memcpy(out, &id, sizeof(id));
+            std::memcpy(out + sizeof(id), &size, sizeof(size));
+            std::memcpy(out + sizeof(id) + sizeof(size), ptr, size);
+            return;
+        }
+        auto size_offset = _size + sizeof(id);
+        put(id, std::uint32_t{});
+        // serializers append to the buffer, trim it to the recorded size first
+        _bytes.resize(_size);
+        serializer->write(ptr, _bytes);
+        _size = _bytes.size();
+        auto size = static_cast<std::uint32_t>(_size - size_offset - sizeof(std::uint32_t));
+        std::memcpy(_bytes.data() + size_offset, &size, sizeof(size));
+    }
+
+    // new components are defined right before the record being written, the player needs names before records
+    auto local_id(component_meta meta) -> std::uint16_t {
+        if (meta.id < _local_ids.size() && _local_ids[meta.id] != no_local_id) {
+            return _local_ids[meta.id];
+        }
+        if (_local_ids.size() <= meta.id) {
+            _local_ids.resize(meta.id + 1, no_local_id);
+        }
+        auto id = static_cast<std::uint16_t>(_serializers.size());
+        _local_ids[meta.id] = id;
+        _serializers.push_back(component_serializers::find(meta.id));
+        auto name_size = static_cast<std::uint16_t>(meta.type->name.size());
+        std::vector<std::byte> definition(sizeof(record) + sizeof(id) + sizeof(name_size) + name_size);
+        auto* out = definition.data();
+        *out++ = static_cast<std::byte>(record::component);
+        std::memcpy(out, &id, sizeof(id));
+        std::memcpy(out + sizeof(id), &name_size, sizeof(name_size));
+        std::memcpy(out + sizeof(id) + sizeof(name_size), meta.type->name.data(), name_size);
+        _bytes.resize(_size);
+        auto record_start = _bytes.begin() + static_cast<std::ptrdiff_t>(_record_start);
+        _bytes.insert(record_start, definition.begin(), definition.end());
+        _size = _bytes.size();
+        _record_start += definition.size();
+        return id;
+    }
+
+    std::vector<std::byte> _bytes;
+    std::size_t _size{};         ///< Number of recorded bytes, the buffer may be larger
+    std::size_t _record_start{}; ///< Offset of the record being written
+    std::uint64_t _frames{};
+    static constexpr std::uint16_t no_local_id = std::numeric_limits<std::uint16_t>::max();
+
+    std::vector<std::uint16_t> _local_ids; ///< Local component IDs by component ID
+    std::vector<const component_serializer*> _serializers; ///< Serializers by local component ID
+};
+
+/// @brief Replays a command log frame by frame.
+///
+/// Entities created by the log are mapped to the entities created by the replay, entities that existed before the
+/// recording started are expected to exist in the replayed registry with the same handles.
+///
+/// @code
+/// co_ecs::registry replayed = load_initial_state();
+/// co_ecs::command_log_player player{ co_ecs::command_log::load(file) };
+///
+/// while (auto inputs = player.next_frame(replayed)) {
+///     check_inputs(*inputs);
+/// }
+/// @endcode
+class command_log_player {
+public:
+    /// @brief Construct a new player
+    ///
+    /// @param bytes Log bytes, from command_log::bytes() or command_log::load()
+    explicit command_log_player(std::vector<std::byte> bytes) : _bytes(std::move(bytes)) {
+        if (_bytes.size() < command_log::magic.size()
+            || !std::equal(command_log::magic.begin(), command_log::magic.end(), _bytes.begin())) {
+            throw replay_error("not a command log");
+        }
+        _offset = command_log::magic.size();
+    }
+
+    /// @brief Apply commands of the next frame
+    ///
+    /// @param registry Registry to apply commands to
+    /// @return std::optional<std::span<const std::byte>> Inputs of the frame or std::nullopt at the end of the log
+    auto next_frame(registry& registry) -> std::optional<std::span<const std::byte>> {
+        if (_offset == _bytes.size()) {
+            return std::nullopt;
+        }
+        if (get<command_log::record>() != command_log::record::frame) {
+            throw replay_error("frame record expected");
+        }
+        get<std::uint64_t>();
+        auto inputs = get_bytes(get<std::uint32_t>());
+
+        while (_offset < _bytes.size() && peek() != command_log::record::frame) {
+            apply(registry);
+        }
+        // ensure created entities are accessible
+        registry.sync();
+        return inputs;
+    }
+
+private:
+    template<typename T>
+    auto get() -> T {
+        if (_offset + sizeof(T) > _bytes.size()) {
+            throw replay_error("truncated command log");
+        }
+        T value;
+        std::memcpy(&value, _bytes.data() + _offset, sizeof(T));
+        _offset += sizeof(T);
+        return value;
+    }
+
+    auto get_bytes(std::size_t size) -> std::span<const std::byte> {
+        if (_offset + size > _bytes.size()) {
+            throw replay_error("truncated command log");
+        }
+        auto bytes = std::span<const std::byte>(_bytes).subspan(_offset, size);
+        _offset += size;
+        return bytes;
+    }
+
+    auto peek() const -> command_log::record {
+        return static_cast<command_log::record>(_bytes[_offset]);
+    }
+
+    auto get_entity() -> entity {
+        auto id = get<typename entity::id_t>();
+        auto generation = get<typename entity::generation_t>();
+        entity ent{ id, generation };
+        if (auto it = _entities.find(ent); it != _entities.end()) {
+            return it->second;
+        }
+        return ent;
+    }
+
+    auto get_serializer() -> const component_serializer& {
+        auto id = get<std::uint16_t>();
+        if (id >= _components.size()) {
+            throw replay_error("undefined component");
+        }
+        if (_components[id].serializer == nullptr) {
+            throw replay_error("no serializer for component " + _components[id].name);
+        }
+        return *_components[id].serializer;
+    }
+
+    void set_component(registry& registry, entity ent) {
+        const auto& serializer = get_serializer();
+        auto size = get<std::uint32_t>();
+        if (size == command_log::unserializable) {
+            throw replay_error("component was recorded without a serializer");
+        }
+        serializer.read(get_bytes(size), registry, ent);
+    }
+
+    void apply(registry& registry) {
+        switch (get<command_log::record>()) {
+        case command_log::record::component: {
+            auto id = get<std::uint16_t>();
+            auto name_bytes = get_bytes(get<std::uint16_t>());
+            std::string name(reinterpret_cast<const char*>(name_bytes.data()), name_bytes.size());
+            if (_components.size() <= id) {
+                _components.resize(id + 1);
+            }
+            _components[id] = component_entry{ name, component_serializers::find(name) };
+            break;
+        }
+        case command_log::record::create: {
+            auto recorded = entity{ get<typename entity::id_t>(), get<typename entity::generation_t>() };
+            entity ent = registry.create();
+            _entities.insert_or_assign(std::pair{ recorded, ent });
+            auto count = get<std::uint16_t>();
+            for (std::uint16_t i = 0; i < count; i++) {
+                set_component(registry, ent);
+            }
+            break;
+        }
+        case command_log::record::clone: {
+            auto source = get_entity();
+            auto recorded = entity{ get<typename entity::id_t>(), get<typename entity::generation_t>() };
+            entity clone = registry.get_entity(source).clone();
+            _entities.insert_or_assign(std::pair{ recorded, clone });
+            break;
+        }
+        case command_log::record::set: {
+            auto ent = get_entity();
+            set_component(registry, ent);
+            break;
+        }
+        case command_log::record::remove: {
+            auto ent = get_entity();
+            get_serializer().remove(registry, ent);
+            break;
+        }
+        case command_log::record::destroy: {
+            registry.destroy(get_entity());
+            break;
+        }
+        default:
+            throw replay_error("unknown record");
+        }
+    }
+
+    struct component_entry {
+        std::string name;
+        const component_serializer* serializer{};
+    };
+
+    struct entity_hash {
+        auto operator()(entity ent) const noexcept -> std::size_t {
+            return std::hash<std::uint64_t>{}((std::uint64_t{ ent.id() } << 32U) | ent.generation());
+        }
+    };
+
+    std::vector<std::byte> _bytes;
+    std::size_t _offset{};
+    std::vector<component_entry> _components;
+    detail::hash_map<entity, entity, entity_hash> _entities;
+};
+
+} // namespace co_ecs
@@ -4,8 +4,10 @@
 #include <bitset>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
+#include <tuple>
 
 #include <co_ecs/detail/dynamic_bitset.hpp>
 #include <co_ecs/detail/hash_map.hpp>
@@ -99,6 +101,111 @@ concept component_reference = std::is_reference_v<T> && component<std::remove_cv
 template<component_reference T>
 using decay_component_t = std::decay_t<T>;
 
+/// @brief Arguments to construct component C with, the component is constructed directly in its chunk row instead of
+/// being constructed on the stack and moved. Holds references to the arguments, so it must be consumed by the call it
+/// is passed to; it can not be copied or moved and does not satisfy the component concept.
+///
+/// @code
+/// registry.create(co_ecs::in_place<mesh>(vertices, 1024), position{ 1, 2 });
+/// @endcode
+///
+/// @tparam C Component type
+/// @tparam Args Constructor argument types
+template<component C, typename... Args>
+class in_place_t {
+public:
+    /// @brief Component type
+    using component_type = C;
+
+    /// @brief Construct from constructor arguments
+    ///
+    /// @param args Constructor arguments
+    constexpr explicit in_place_t(Args&&... args) noexcept : _args(std::forward<Args>(args)...) {
+    }
+
+    in_place_t(const in_place_t&) = delete;
+    in_place_t(in_place_t&&) = delete;
+    auto operator=(const in_place_t&) -> in_place_t& = delete;
+    auto operator=(in_place_t&&) -> in_place_t& = delete;
+
+    /// @brief Construct the component at given address
+    ///
+    /// @param ptr Uninitialized storage for C
+    /// @return C* Constructed component
+    constexpr auto construct_at(C* ptr) && -> C* {
+        return std::apply(
+            [ptr](auto&&... args) { return std::construct_at(ptr, std::forward<decltype(args)>(args)...); },
+            std::move(_args));
+    }
+
+private:
+    std::tuple<Args&&...> _args;
+};
+
+/// @brief Make in_place_t for component C
+///
+/// @tparam C Component type
+/// @tparam Args Constructor argument types
+/// @param args Constructor arguments
+/// @return in_place_t<C, Args...> Arguments to construct C in place with
+template<component C, typename... Args>
+constexpr auto in_place(Args&&... args) noexcept -> in_place_t<C, Args...> {
+    return in_place_t<C, Args...>(std::forward<Args>(args)...);
+}
+
+namespace detail {
+
+template<typename T>
+struct in_place_traits {
+    constexpr static bool value = false;
+    using component_type = T;
+};
+
+template<component C, typename... Args>
+struct in_place_traits<in_place_t<C, Args...>> {
+    constexpr static bool value = true;
+    using component_type = C;
+};
+
+} // namespace detail
+
+/// @brief In place construction concept, satisfied by in_place_t
+///
+/// @tparam T Type
+template<typename T>
+concept in_place_construction = detail::in_place_traits<std::remove_cvref_t<T>>::value;
+
+/// @brief Component type constructed from an argument, C for in_place_t<C, Args...> and the decayed type otherwise
+///
+/// @tparam T Argument type
+template<typename T>
+using constructed_component_t = typename detail::in_place_traits<std::remove_cvref_t<T>>::component_type;
+
+/// @brief Argument a component can be constructed from, a component value or in_place_t
+///
+/// @tparam T Argument type
+template<typename T>
+concept component_argument = in_place_construction<T> || component<std::remove_cvref_t<T>>;
+
+namespace detail {
+
+/// @brief Construct a component from a component value or in_place_t
+///
+/// @tparam C Component type
+/// @tparam Arg Argument type
+/// @param ptr Uninitialized storage for C
+/// @param arg Component value or in_place_t
+template<component C, component_argument Arg>
+constexpr void construct_component(C* ptr, Arg&& arg) {
+    if constexpr (in_place_construction<Arg>) {
+        std::forward<Arg>(arg).construct_at(ptr);
+    } else {
+        std::construct_at(ptr, std::forward<Arg>(arg));
+    }
+}
+
+} // namespace detail
+
 /// @brief Struct to determine const-ness of component reference type
 ///
 /// @tparam T component reference type
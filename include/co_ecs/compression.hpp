@@ -0,0 +1,82 @@
+#pragma once
+
+#include <co_ecs/registry.hpp>
+
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief Compresses chunks that have not been modified for a number of sweeps.
+///
+/// Every sweep compares chunk versions with the ones seen by the previous sweep, a chunk that kept its version for
+/// idle_sweeps sweeps in a row is compressed in place and its buffer is released. Compressed chunks are decompressed
+/// transparently on the first access through a view, an entity reference or a structural change. Const access does not
+/// change the chunk version, so a chunk woken up by an access is never compressed again, otherwise chunks that are read
+/// every frame but never written, e.g. static level data, would stall on every idle_sweeps sweep.
+///
+/// @code
+/// co_ecs::chunk_compressor compressor{ 600 }; // ~10 seconds at 60 frames per second
+///
+/// while (running) {
+///     executor->run_once();
+///     compressor.sweep(registry);
+/// }
+///
+/// auto stats = co_ecs::chunk::compression_statistics();
+/// std::cout << stats.ratio() << " " << stats.stalls << "\n";
+/// @endcode
+///
+/// @note Sweep must not run concurrently with systems, call it in between frames.
+class chunk_compressor {
+public:
+    /// @brief Construct a new chunk compressor object
+    ///
+    /// @param idle_sweeps Number of sweeps a chunk has to stay unmodified to be compressed
+    explicit chunk_compressor(std::size_t idle_sweeps) noexcept : _idle_sweeps(idle_sweeps) {
+    }
+
+    /// @brief Update idle counters of all chunks and compress the ones idle for long enough
+    ///
+    /// @param registry Registry
+    /// @return std::size_t Number of chunks compressed by this sweep
+    auto sweep(registry& registry) -> std::size_t {
+        auto& archetypes = registry.archetypes();
+        _chunks.resize(archetypes.size());
+
+        std::size_t compressed{};
+        for (std::size_t archetype_index = 0; archetype_index < archetypes.size(); archetype_index++) {
+            auto& chunks = archetypes.by_index(archetype_index)->chunks();
+            auto& states = _chunks[archetype_index];
+            states.resize(chunks.size());
+
+            for (std::size_t chunk_index = 0; chunk_index < chunks.size(); chunk_index++) {
+                auto& chunk = chunks[chunk_index];
+                auto& state = states[chunk_index];
+                if (chunk.compressed() || chunk.woken()) {
+                    continue;
+                }
+                if (state.version != chunk.version()) {
+                    // modified since the last sweep
+                    state = chunk_state{ chunk.version() };
+                    continue;
+                }
+                if (++state.idle >= _idle_sweeps && chunk.compress()) {
+                    compressed++;
+                }
+            }
+        }
+
+        return compressed;
+    }
+
+private:
+    struct chunk_state {
+        std::uint64_t version{};
+        std::size_t idle{};
+    };
+
+    std::size_t _idle_sweeps;
+    std::vector<std::vector<chunk_state>> _chunks;
+};
+
+} // namespace co_ecs
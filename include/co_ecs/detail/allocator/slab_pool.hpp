@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace co_ecs::detail {
+
+/// @brief Pool of slabs for out-of-line component columns.
+///
+/// Slab sizes are rounded up to a power of two and freed slabs are kept in a free list per size class, so a column
+/// that grows, shrinks or moves to a new chunk reuses memory instead of going to the system allocator. When the cached
+/// free slabs outgrow the slabs in use the pool is fragmented and it releases the cached slabs back to the system.
+class slab_pool {
+public:
+    /// @brief Alignment of every slab
+    static constexpr std::size_t slab_alignment = 64;
+
+    /// @brief Smallest slab size
+    static constexpr std::size_t min_slab_bytes = 64;
+
+    /// @brief Cached free bytes kept regardless of fragmentation
+    static constexpr std::size_t min_cached_bytes = static_cast<std::size_t>(1024U * 1024); // 1 MB
+
+    /// @brief Get global slab pool
+    ///
+    /// @return slab_pool& Slab pool
+    static auto get() -> slab_pool& {
+        static slab_pool pool;
+        return pool;
+    }
+
+    slab_pool() = default;
+    slab_pool(const slab_pool&) = delete;
+    slab_pool& operator=(const slab_pool&) = delete;
+
+    /// @brief Release all slabs cached in free lists
+    ~slab_pool() {
+        compact();
+    }
+
+    /// @brief Allocate a slab of at least the given number of bytes
+    ///
+    /// @param bytes Number of bytes
+    /// @return std::byte* Pointer to the slab aligned to slab_alignment
+    [[nodiscard]] auto allocate(std::size_t bytes) -> std::byte* {
+        auto size_class = get_size_class(bytes);
+        std::lock_guard lock(_mutex);
+        auto& free_list = _free_lists[size_class];
+        _used_bytes += class_bytes(size_class);
+        if (!free_list.empty()) {
+            auto* slab = free_list.back();
+            free_list.pop_back();
+            _cached_bytes -= class_bytes(size_class);
+            return slab;
+        }
+        return static_cast<std::byte*>(::operator new(class_bytes(size_class), std::align_val_t{ slab_alignment }));
+    }
+
+    /// @brief Return a slab to the pool
+    ///
+    /// @param slab Slab pointer returned from allocate()
+    /// @param bytes Number of bytes passed to allocate()
+    void deallocate(std::byte* slab, std::size_t bytes) noexcept {
+        if (slab == nullptr) {
+            return;
+        }
+        auto size_class = get_size_class(bytes);
+        std::lock_guard lock(_mutex);
+        _used_bytes -= class_bytes(size_class);
+        try {
+            _free_lists[size_class].push_back(slab);
+            _cached_bytes += class_bytes(size_class);
+        } catch (const std::bad_alloc&) {
+            release(slab, size_class);
+        }
+        if (_cached_bytes > min_cached_bytes && _cached_bytes > _used_bytes) {
+            compact_unlocked();
+        }
+    }
+
+    /// @brief Release all cached free slabs
+    void compact() noexcept {
+        std::lock_guard lock(_mutex);
+        compact_unlocked();
+    }
+
+    /// @brief Get number of bytes in slabs currently in use
+    ///
+    /// @return std::size_t Bytes in use
+    [[nodiscard]] auto used_bytes() const noexcept -> std::size_t {
+        std::lock_guard lock(_mutex);
+        return _used_bytes;
+    }
+
+    /// @brief Get number of bytes in cached free slabs
+    ///
+    /// @return std::size_t Cached bytes
+    [[nodiscard]] auto cached_bytes() const noexcept -> std::size_t {
+        std::lock_guard lock(_mutex);
+        return _cached_bytes;
+    }
+
+private:
+    static constexpr std::size_t size_classes = 48;
+
+    static constexpr auto get_size_class(std::size_t bytes) noexcept -> std::size_t {
+        auto rounded = std::bit_ceil(std::max(bytes, min_slab_bytes));
+        auto size_class = static_cast<std::size_t>(std::countr_zero(rounded) - std::countr_zero(min_slab_bytes));
+        assert((size_class < size_classes) && "Slab size is out of range");
+        return size_class;
+    }
+
+    static constexpr auto class_bytes(std::size_t size_class) noexcept -> std::size_t {
+        return min_slab_bytes << size_class;
+    }
+
+    static void release(std::byte* slab, std::size_t size_class) noexcept {
+        ::operator delete(slab, class_bytes(size_class), std::align_val_t{ slab_alignment });
+    }
+
+    void compact_unlocked() noexcept {
+        for (std::size_t size_class = 0; size_class < size_classes; size_class++) {
+            for (auto* slab : _free_lists[size_class]) {
+                release(slab, size_class);
+            }
+            _free_lists[size_class].clear();
+        }
+        _cached_bytes = 0;
+    }
+
+    mutable std::mutex _mutex;
+    std::array<std::vector<std::byte*>, size_classes> _free_lists{};
+    std::size_t _used_bytes{};
+    std::size_t _cached_bytes{};
+};
+
+} // namespace co_ecs::detail
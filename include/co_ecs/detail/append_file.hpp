@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CO_ECS_POSIX_FILE
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace co_ecs::detail {
+
+/// @brief Append only file with durable sync. Uses write and fdatasync on POSIX platforms, other platforms fall back to
+/// a flushed std::ofstream which only guarantees the data reached the operating system.
+class append_file {
+public:
+    /// @brief Create or truncate a file
+    ///
+    /// @param path File path
+    explicit append_file(const std::string& path) {
+#ifdef CO_ECS_POSIX_FILE
+        _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "failed to open " + path);
+        }
+#else
+        _file.open(path, std::ios::binary | std::ios::trunc);
+        if (!_file) {
+            throw std::system_error(std::make_error_code(std::errc::io_error), "failed to open " + path);
+        }
+#endif
+    }
+
+    append_file(const append_file&) = delete;
+    append_file& operator=(const append_file&) = delete;
+
+    /// @brief Close the file
+    ~append_file() {
+#ifdef CO_ECS_POSIX_FILE
+        ::close(_fd);
+#endif
+    }
+
+    /// @brief Append bytes to the file
+    ///
+    /// @param bytes Bytes
+    void write(std::span<const std::byte> bytes) {
+#ifdef CO_ECS_POSIX_FILE
+        while (!bytes.empty()) {
+            auto written = ::write(_fd, bytes.data(), bytes.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "failed to write");
+            }
+            bytes = bytes.subspan(static_cast<std::size_t>(written));
+        }
+#else
+        _file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!_file) {
+            throw std::system_error(std::make_error_code(std::errc::io_error), "failed to write");
+        }
+#endif
+    }
+
+    /// @brief Wait until appended bytes reach the storage
+    void sync() {
+#if defined(__APPLE__)
+        auto result = ::fsync(_fd);
+#elif defined(CO_ECS_POSIX_FILE)
+        auto result = ::fdatasync(_fd);
+#else
+        _file.flush();
+        auto result = _file ? 0 : -1;
+#endif
+        if (result != 0) {
+            throw std::system_error(std::make_error_code(std::errc::io_error), "failed to sync");
+        }
+    }
+
+private:
+#ifdef CO_ECS_POSIX_FILE
+    int _fd{ -1 };
+#else
+    std::ofstream _file;
+#endif
+};
+
+} // namespace co_ecs::detail
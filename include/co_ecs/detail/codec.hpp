@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace co_ecs::detail {
+
+/// @brief Byte codec for arrays of fixed size elements, used to compress idle chunks.
+///
+/// Every element is XORed with the previous one, so fields that are equal or change slowly between neighbouring
+/// elements turn into zero bytes. The resulting stream is then split into runs of zero bytes, stored as a single
+/// token, and runs of literal bytes, stored as a token followed by the bytes. A token below 0x80 starts a literal run
+/// of token + 1 bytes, a token of 0x80 or above is a zero run of token - 0x7F bytes.
+struct delta_rle_codec {
+    /// @brief Longest run a single token can describe
+    static constexpr std::size_t max_run = 128;
+
+    /// @brief Encode size bytes of elements of the given stride and append the result to out
+    ///
+    /// @param data Input bytes
+    /// @param size Number of input bytes, a multiple of stride
+    /// @param stride Element size in bytes
+    /// @param out Output buffer
+    static void encode(const std::byte* data, std::size_t size, std::size_t stride, std::vector<std::byte>& out) {
+        assert((stride != 0 && size % stride == 0) && "Size has to be a multiple of stride");
+
+        auto delta = [&](std::size_t i) -> std::byte { return i < stride ? data[i] : data[i] ^ data[i - stride]; };
+
+        std::size_t i = 0;
+        while (i < size) {
+            if (delta(i) == std::byte{}) {
+                std::size_t run = 1;
+                while (i + run < size && run < max_run && delta(i + run) == std::byte{}) {
+                    run++;
+                }
+                out.push_back(static_cast<std::byte>(0x7F + run));
+                i += run;
+                continue;
+            }
+
+            // a literal run ends before two zero bytes in a row, a single zero is cheaper to keep as a literal
+            std::size_t run = 1;
+            while (i + run < size && run < max_run
+                   && !(delta(i + run) == std::byte{} && (i + run + 1 == size || delta(i + run + 1) == std::byte{}))) {
+                run++;
+            }
+            out.push_back(static_cast<std::byte>(run - 1));
+            for (std::size_t j = 0; j < run; j++) {
+                out.push_back(delta(i + j));
+            }
+            i += run;
+        }
+    }
+
+    /// @brief Decode size bytes of elements of the given stride from in, advances in past the consumed tokens
+    ///
+    /// @param in Input pointer, updated to point past the decoded data
+    /// @param out Output bytes
+    /// @param size Number of bytes to decode, a multiple of stride
+    /// @param stride Element size in bytes
+    static void decode(const std::byte*& in, std::byte* out, std::size_t size, std::size_t stride) noexcept {
+        std::size_t i = 0;
+        while (i < size) {
+            auto token = static_cast<std::uint8_t>(*in++);
+            if (token >= 0x80) {
+                std::size_t run = token - 0x7F;
+                std::fill_n(out + i, run, std::byte{});
+                i += run;
+            } else {
+                std::size_t run = token + 1U;
+                std::copy_n(in, run, out + i);
+                in += run;
+                i += run;
+            }
+        }
+
+        for (i = stride; i < size; i++) {
+            out[i] ^= out[i - stride];
+        }
+    }
+};
+
+} // namespace co_ecs::detail
@@ -1,25 +1,78 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cassert>
+#include <concepts>
 #include <cstdint>
-#include <numeric>
+#include <limits>
+#include <stdexcept>
+#include <span>
 #include <vector>
 
 namespace co_ecs::detail {
 
-/// @brief Represents a handle with an ID and a generation index.
+/// @brief Bit layout of a handle, an ID in the low bits and a generation in the high bits of Storage
+///
+/// @tparam Storage Unsigned integer type holding the handle
+/// @tparam IdBits Number of bits for the ID
+template<std::unsigned_integral Storage, std::size_t IdBits>
+    requires(IdBits > 0 && IdBits < sizeof(Storage) * 8 && IdBits <= 32 && sizeof(Storage) * 8 - IdBits <= 32)
+struct handle_layout {
+    using storage_type = Storage;
+
+    /// @brief Number of bits for the ID
+    static constexpr std::size_t id_bits = IdBits;
+
+    /// @brief Number of bits for the generation
+    static constexpr std::size_t generation_bits = sizeof(Storage) * 8 - IdBits;
+
+    /// @brief Number of free IDs a handle pool keeps queued before reusing one. Free IDs are reused first in first out,
+    /// so a stale handle can alias a live one only after its ID went through the whole queue once per generation.
+    /// Generations of 16 bits and more take long enough to wrap to reuse IDs right away.
+    static constexpr std::size_t min_free_ids = generation_bits < 16 ? std::size_t{ 1 } << 10 : 0;
+};
+
+/// @brief 32-bit ID and 32-bit generation in 64 bits, the default layout
+using wide_handle_layout = handle_layout<std::uint64_t, 32>;
+
+/// @brief 24-bit ID and 8-bit generation in 32 bits, halves the entity block of chunks and stored references at the
+/// cost of at most 16M handles and generations wrapping after 256 reuses of an ID
+using compact_handle_layout = handle_layout<std::uint32_t, 24>;
+
+/// @brief Layout of handles with the given tag, the tag selects a layout by declaring a layout type alias
+///
+/// @tparam Tag Handle tag
+template<typename Tag>
+struct handle_layout_of {
+    using type = wide_handle_layout;
+};
+
+/// @brief Layout of handles with the given tag, the tag selects a layout by declaring a layout type alias
+///
+/// @tparam Tag Handle tag
+template<typename Tag>
+    requires requires { typename Tag::layout; }
+struct handle_layout_of<Tag> {
+    using type = typename Tag::layout;
+};
+
+/// @brief Represents a handle with an ID and a generation index packed according to the layout selected by the tag.
 /// @tparam Tag The type used to distinguish between handles.
 template<typename Tag>
 class handle {
 public:
+    using layout = typename handle_layout_of<Tag>::type;
+    using storage_type = typename layout::storage_type;
     using id_t = std::uint32_t;
     using generation_t = std::uint32_t;
 
     /// @brief Invalid ID number for handles.
-    static constexpr auto invalid_id = std::numeric_limits<id_t>::max();
+    static constexpr auto invalid_id = static_cast<id_t>((std::uint64_t{ 1 } << layout::id_bits) - 1);
 
     /// @brief Invalid generation number for handles.
-    static constexpr auto invalid_generation = std::numeric_limits<generation_t>::max();
+    static constexpr auto invalid_generation =
+        static_cast<generation_t>((std::uint64_t{ 1 } << layout::generation_bits) - 1);
 
     /// @brief Returns an invalid handle.
     /// @return Invalid handle
@@ -31,9 +84,13 @@ public:
     constexpr handle() = default;
 
     /// @brief Constructs a handle from an ID and a generation.
-    /// @param id ID number
-    /// @param generation Generation number
-    explicit constexpr handle(id_t id, generation_t generation = 0) noexcept : _id(id), _generation(generation) {
+    /// @param id ID number, at most invalid_id
+    /// @param generation Generation number, at most invalid_generation
+    explicit constexpr handle(id_t id, generation_t generation = 0) noexcept :
+        _value(static_cast<storage_type>(
+            (static_cast<storage_type>(generation) << layout::id_bits) | static_cast<storage_type>(id))) {
+        assert(id <= invalid_id && "Handle ID does not fit the layout");
+        assert(generation <= invalid_generation && "Handle generation does not fit the layout");
     }
 
     /// @brief Checks if the handle is valid.
@@ -44,41 +101,60 @@ public:
 
     /// @brief Gets the ID number of the handle.
     /// @return ID number
-    [[nodiscard]] constexpr auto id() const noexcept {
-        return _id;
+    [[nodiscard]] constexpr auto id() const noexcept -> id_t {
+        return static_cast<id_t>(_value & invalid_id);
     }
 
     /// @brief Gets the generation number of the handle.
     /// @return Generation number
-    [[nodiscard]] constexpr auto generation() const noexcept {
-        return _generation;
+    [[nodiscard]] constexpr auto generation() const noexcept -> generation_t {
+        return static_cast<generation_t>(_value >> layout::id_bits);
     }
 
-    /// @brief Spaceship operator for handles.
+    /// @brief Equality operator for handles.
+    /// @param rhs Other handle
+    /// @return True if equal
+    [[nodiscard]] constexpr auto operator==(const handle& rhs) const noexcept -> bool = default;
+
+    /// @brief Spaceship operator for handles, orders by ID and then by generation.
     /// @param rhs Other handle
     /// @return Comparison result
-    [[nodiscard]] constexpr auto operator<=>(const handle& rhs) const = default;
+    [[nodiscard]] constexpr auto operator<=>(const handle& rhs) const noexcept {
+        if (auto cmp = id() <=> rhs.id(); cmp != 0) {
+            return cmp;
+        }
+        return generation() <=> rhs.generation();
+    }
 
 private:
-    id_t _id{ invalid_id };
-    generation_t _generation{ invalid_generation };
+    storage_type _value{ std::numeric_limits<storage_type>::max() };
 };
 
-/// @brief Pool of handles that generates and recycles handle IDs.
+/// @brief Pool of handles that generates and recycles handle IDs. Recycling bumps the generation of an ID and queues it
+/// for reuse first in first out, behind at least layout::min_free_ids other free IDs. Generations wrap around, a stale
+/// handle becomes alive again only once its ID has been reused as many times as there are generations, which takes at
+/// least that many times min_free_ids recycles.
 /// @tparam H Handle type
 template<typename H>
 class handle_pool {
 public:
+    /// @brief Number of free IDs kept queued before one is reused
+    static constexpr std::size_t min_free_ids = H::layout::min_free_ids;
+
     /// @brief Creates a new handle.
     /// @return Handle
     [[nodiscard]] constexpr auto create() -> H {
-        if (!_free_ids.empty()) {
-            auto id = _free_ids.back();
-            _free_ids.pop_back();
-            _free_cursor.store(_free_ids.size(), std::memory_order::relaxed);
+        if (_reserved.load(std::memory_order::relaxed) != 0) {
+            // reserved handles take queued and new IDs, account for them first
+            flush();
+        }
+        if (free_count() > min_free_ids) {
+            auto id = _free_ids[_free_head++];
+            compact();
+            update_reservable();
             return H{ id, _generations[id] };
         }
-        auto handle = H{ _next_id.fetch_add(1, std::memory_order::relaxed) };
+        auto handle = H{ next_id() };
         _generations.emplace_back();
         return handle;
     };
@@ -99,43 +175,96 @@ public:
         if (!alive(handle)) {
             return;
         }
-        _generations[handle.id()]++;
-        _free_ids.push_back(handle.id());
-        _free_cursor.fetch_add(1, std::memory_order::relaxed);
+        release(handle.id());
+        update_reservable();
+    }
+
+    /// @brief Recycles handles for reuse in future creations. Handles that are not alive are skipped.
+    /// @param handles Handles to recycle
+    constexpr void recycle(std::span<const H> handles) {
+        _free_ids.reserve(_free_ids.size() + handles.size());
+        for (auto handle : handles) {
+            if (alive(handle)) {
+                release(handle.id());
+            }
+        }
+        update_reservable();
+    }
+
+    /// @brief Recycles all handles at once. Generations of all IDs are bumped so previously created handles are no
+    /// longer alive, IDs are then handed out again starting from the lowest one.
+    /// @pre No handles are reserved and not yet flushed.
+    constexpr void clear() {
+        _free_ids.clear();
+        _free_head = 0;
+        for (typename H::id_t id = 0; id < _generations.size(); id++) {
+            release(id);
+        }
+        _reserved.store(0, std::memory_order::relaxed);
+        update_reservable();
     }
 
     /// @brief Reserves a handle.
     /// @details This call is thread-safe.
     /// @return Reserved handle
     constexpr auto reserve() -> H {
-        auto n = _free_cursor.fetch_sub(1, std::memory_order::relaxed);
-        if (n > 0) {
-            auto id = _free_ids[n - 1];
+        auto n = _reserved.fetch_add(1, std::memory_order::relaxed);
+        if (n < _reservable) {
+            auto id = _free_ids[_free_head + n];
             return H{ id, _generations[id] };
         }
-        auto handle = H{ _next_id.fetch_add(1, std::memory_order::relaxed) };
+        auto handle = H{ next_id() };
         return handle;
     }
 
     /// @brief Flushes reserved handles.
     constexpr void flush() {
-        auto free_cursor = _free_cursor.load(std::memory_order::relaxed);
+        auto reserved = _reserved.exchange(0, std::memory_order::relaxed);
+        _free_head += std::min(reserved, _reservable);
+        // reservations past the last ID have thrown but still advanced the counter
+        _generations.resize(std::min<std::size_t>(_next_id.load(std::memory_order::relaxed), H::invalid_id));
+        compact();
+        update_reservable();
+    }
 
-        while (free_cursor < 0) {
-            _generations.emplace_back();
-            free_cursor++;
+private:
+    // Takes a never used ID, throws when the layout has no IDs left
+    auto next_id() -> typename H::id_t {
+        auto id = _next_id.fetch_add(1, std::memory_order::relaxed);
+        if (id >= H::invalid_id) {
+            throw std::length_error("handle IDs exhausted");
         }
+        return id;
+    }
 
-        while (_free_ids.size() > free_cursor) {
-            _free_ids.pop_back();
-        }
+    [[nodiscard]] constexpr auto free_count() const noexcept -> std::size_t {
+        return _free_ids.size() - _free_head;
+    }
 
-        _free_cursor.store(free_cursor, std::memory_order::relaxed);
+    // Bumps the generation of an ID, wrapping around within the generation bits, and queues the ID for reuse
+    constexpr void release(typename H::id_t id) {
+        _generations[id] = (_generations[id] + 1) & H::invalid_generation;
+        _free_ids.push_back(id);
+    }
+
+    // Number of queued IDs reserve() may take, queued IDs are indexed from the head so recycling does not move them
+    constexpr void update_reservable() noexcept {
+        auto free = free_count();
+        _reservable = free > min_free_ids ? free - min_free_ids : 0;
+    }
+
+    // Drops taken IDs from the front of the queue once they make up half of it, called without pending reservations
+    constexpr void compact() {
+        if (_free_head != 0 && _free_head * 2 >= _free_ids.size()) {
+            _free_ids.erase(_free_ids.begin(), _free_ids.begin() + static_cast<std::ptrdiff_t>(_free_head));
+            _free_head = 0;
+        }
     }
 
-private:
     std::atomic<typename H::id_t> _next_id{};
-    std::atomic<std::int64_t> _free_cursor{};
+    std::atomic<std::size_t> _reserved{};
+    std::size_t _reservable{};
+    std::size_t _free_head{};
     std::vector<typename H::generation_t> _generations;
     std::vector<typename H::id_t> _free_ids;
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) && !defined(CO_ECS_DISABLE_NUMA)
+#define CO_ECS_NUMA
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace co_ecs::detail::numa {
+
+/// @brief Page size memory has to be aligned to for binding it to a node
+constexpr std::size_t page_size = 4096;
+
+/// @brief Node of memory that has not been bound to any node
+constexpr std::size_t unknown_node = static_cast<std::size_t>(-1);
+
+/// @brief NUMA topology, read once from sysfs. A machine with a single node, a platform other than Linux or a build
+/// with CO_ECS_DISABLE_NUMA defined is reported as a single node and every call below becomes a no-op.
+class topology {
+public:
+    /// @brief Get topology of this machine
+    ///
+    /// @return const topology& Topology
+    static auto get() -> const topology& {
+        static const topology instance;
+        return instance;
+    }
+
+    /// @brief Get number of NUMA nodes
+    ///
+    /// @return std::size_t Number of nodes, at least 1
+    [[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+        return _num_nodes;
+    }
+
+    /// @brief Check if the machine has more than one node
+    ///
+    /// @return true If memory placement matters
+    [[nodiscard]] auto enabled() const noexcept -> bool {
+        return _num_nodes > 1;
+    }
+
+    /// @brief Get node of the CPU the calling thread runs on
+    ///
+    /// @return std::size_t Node
+    [[nodiscard]] auto current_node() const noexcept -> std::size_t {
+#ifdef CO_ECS_NUMA
+        if (enabled()) {
+            auto cpu = sched_getcpu();
+            if (cpu >= 0 && static_cast<std::size_t>(cpu) < _cpu_nodes.size()) {
+                return _cpu_nodes[cpu];
+            }
+        }
+#endif
+        return 0;
+    }
+
+    /// @brief Prefer the given node for pages in [ptr, ptr + bytes), pages already placed elsewhere are moved.
+    /// Failures are ignored, the memory stays where it is.
+    ///
+    /// @param ptr Page aligned pointer
+    /// @param bytes Number of bytes
+    /// @param node Node
+    void bind(void* ptr, std::size_t bytes, std::size_t node) const noexcept {
+#ifdef CO_ECS_NUMA
+        if (!enabled() || node >= _num_nodes) {
+            return;
+        }
+        constexpr int mpol_preferred = 1;
+        constexpr unsigned mpol_mf_move = 1U << 1U;
+        constexpr std::size_t bits = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask((_num_nodes + bits - 1) / bits);
+        mask[node / bits] |= 1UL << (node % bits);
+        // the kernel expects maxnode to be one more than the number of bits it reads
+        syscall(SYS_mbind, ptr, bytes, mpol_preferred, mask.data(), mask.size() * bits + 1, mpol_mf_move);
+#endif
+    }
+
+private:
+    topology() {
+#ifdef CO_ECS_NUMA
+        for (std::size_t node = 0;; node++) {
+            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!cpulist) {
+                break;
+            }
+            _num_nodes = node + 1;
+
+            // cpulist is a comma separated list of ranges, e.g. 0-7,16-23
+            std::string range;
+            while (std::getline(cpulist, range, ',')) {
+                auto dash = range.find('-');
+                try {
+                    auto first = std::stoul(range.substr(0, dash));
+                    auto last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                    if (_cpu_nodes.size() <= last) {
+                        _cpu_nodes.resize(last + 1, 0);
+                    }
+                    for (auto cpu = first; cpu <= last; cpu++) {
+                        _cpu_nodes[cpu] = node;
+                    }
+                } catch (const std::exception&) {
+                    // malformed entry, keep the CPUs mapped to node 0
+                }
+            }
+        }
+#endif
+    }
+
+    std::size_t _num_nodes{ 1 };
+    std::vector<std::size_t> _cpu_nodes;
+};
+
+} // namespace co_ecs::detail::numa
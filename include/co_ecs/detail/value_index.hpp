@@ -0,0 +1,136 @@
+#pragma once
+
+#include <co_ecs/archetype.hpp>
+#include <co_ecs/component.hpp>
+#include <co_ecs/detail/hash_map.hpp>
+#include <co_ecs/entity.hpp>
+#include <co_ecs/entity_location.hpp>
+
+#include <functional>
+#include <optional>
+
+namespace co_ecs::detail {
+
+/// @brief Type erased index over a component, the registry notifies it about entities whose component may have changed
+class value_index_base {
+public:
+    /// @brief Construct a new value index base object
+    ///
+    /// @param id Indexed component ID
+    explicit value_index_base(component_id_t id) noexcept : _component_id(id) {
+    }
+
+    /// @brief Destroy the value index base object
+    virtual ~value_index_base() = default;
+
+    /// @brief Get indexed component ID
+    ///
+    /// @return component_id_t Component ID
+    [[nodiscard]] auto component_id() const noexcept -> component_id_t {
+        return _component_id;
+    }
+
+    /// @brief Re-read the key of an entity, drops the entity from the index when it no longer has the component
+    ///
+    /// @param ent Entity
+    /// @param location Current location of the entity
+    virtual void update(entity ent, const entity_location& location) = 0;
+
+    /// @brief Drop an entity from the index
+    ///
+    /// @param ent Entity
+    virtual void erase(entity ent) = 0;
+
+    /// @brief Drop all entities from the index
+    virtual void clear() noexcept = 0;
+
+private:
+    component_id_t _component_id;
+};
+
+/// @brief Hash index mapping a key derived from component C to the entity holding it. Keys are expected to be unique,
+/// when two entities share a key the one indexed last is found.
+///
+/// @tparam C Component type
+/// @tparam Key Key type
+template<component C, typename Key>
+class value_index : public value_index_base {
+public:
+    /// @brief Function deriving a key from a component
+    using key_func = std::function<Key(const C&)>;
+
+    /// @brief Construct a new value index object
+    ///
+    /// @param func Function deriving a key from a component
+    explicit value_index(key_func func) : value_index_base(component_meta::of<C>().id), _key_func(std::move(func)) {
+    }
+
+    /// @brief Re-read the key of an entity, drops the entity from the index when it no longer has the component
+    ///
+    /// @param ent Entity
+    /// @param location Current location of the entity
+    void update(entity ent, const entity_location& location) override {
+        const auto* archetype = location.archetype;
+        if (!archetype->template contains<C>()) {
+            erase(ent);
+            return;
+        }
+
+        auto key = _key_func(archetype->template get<C>(location));
+        if (auto it = _keys.find(ent.id()); it != _keys.end()) {
+            if (it->second == key && _entities.contains(key) && _entities.at(key) == ent) {
+                return;
+            }
+            erase(ent);
+        }
+        _entities.insert_or_assign({ key, ent });
+        _keys.insert_or_assign({ ent.id(), std::move(key) });
+    }
+
+    /// @brief Drop an entity from the index
+    ///
+    /// @param ent Entity
+    void erase(entity ent) override {
+        auto it = _keys.find(ent.id());
+        if (it == _keys.end()) {
+            return;
+        }
+        // the key may have been taken over by another entity since
+        if (auto entity_it = _entities.find(it->second);
+            entity_it != _entities.end() && entity_it->second.id() == ent.id()) {
+            _entities.erase(entity_it);
+        }
+        _keys.erase(it);
+    }
+
+    /// @brief Drop all entities from the index
+    void clear() noexcept override {
+        _entities.clear();
+        _keys.clear();
+    }
+
+    /// @brief Find the entity holding key
+    ///
+    /// @param key Key
+    /// @return std::optional<entity> Entity or std::nullopt
+    [[nodiscard]] auto find(const Key& key) const -> std::optional<entity> {
+        if (auto it = _entities.find(key); it != _entities.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    /// @brief Get number of indexed entities
+    ///
+    /// @return std::size_t Number of entities
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return _entities.size();
+    }
+
+private:
+    key_func _key_func;
+    hash_map<Key, entity> _entities;
+    hash_map<typename entity::id_t, Key> _keys;
+};
+
+} // namespace co_ecs::detail
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace co_ecs {
+
+/// @brief Pair of buffers for pipelined producers and consumers.
+///
+/// The producer writes into the back buffer while consumers read the front buffer, swap() publishes the back buffer
+/// once both sides are done with the current frame.
+///
+/// @code
+/// co_ecs::double_buffer<std::vector<transform>> transforms;
+///
+/// view.par_extract(transforms.back());
+/// transforms.swap();
+/// renderer.submit(transforms.front());
+/// @endcode
+///
+/// @tparam T Buffer type
+template<typename T>
+class double_buffer {
+public:
+    /// @brief Get the buffer consumers read from
+    ///
+    /// @return Front buffer
+    [[nodiscard]] auto front() noexcept -> T& {
+        return _buffers[_front];
+    }
+
+    /// @brief Get the buffer consumers read from, const variant
+    ///
+    /// @return Front buffer
+    [[nodiscard]] auto front() const noexcept -> const T& {
+        return _buffers[_front];
+    }
+
+    /// @brief Get the buffer the producer writes to
+    ///
+    /// @return Back buffer
+    [[nodiscard]] auto back() noexcept -> T& {
+        return _buffers[_front ^ 1];
+    }
+
+    /// @brief Get the buffer the producer writes to, const variant
+    ///
+    /// @return Back buffer
+    [[nodiscard]] auto back() const noexcept -> const T& {
+        return _buffers[_front ^ 1];
+    }
+
+    /// @brief Swap front and back buffers
+    void swap() noexcept {
+        _front ^= 1;
+    }
+
+private:
+    std::array<T, 2> _buffers{};
+    std::size_t _front{};
+};
+
+} // namespace co_ecs
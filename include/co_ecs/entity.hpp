@@ -9,8 +9,18 @@
 
 namespace co_ecs {
 
+/// @brief Tag of entity handles, selects the handle layout. Define CO_ECS_COMPACT_ENTITY to pack entities into 32 bits
+/// with a 24-bit ID and an 8-bit generation.
+struct entity_tag_t {
+#ifdef CO_ECS_COMPACT_ENTITY
+    using layout = detail::compact_handle_layout;
+#else
+    using layout = detail::wide_handle_layout;
+#endif
+};
+
 /// @brief Represents an entity, consisting of an ID and generation.
-using entity = detail::handle<struct entity_tag_t>;
+using entity = detail::handle<entity_tag_t>;
 
 /// @brief Pool of entities that generates and recycles entity IDs.
 using entity_pool = detail::handle_pool<entity>;
@@ -151,6 +151,7 @@ public:
         auto [inserted, ptr] = _registry.get().set_impl<C>(_entity);
         if (inserted) {
             std::construct_at(ptr, std::forward<decltype(args)>(args)...);
+            _registry.get().index_update(_entity);
         }
         return *ptr;
     }
@@ -181,6 +182,7 @@ public:
         } else {
             *ptr = C{ std::forward<Args>(args)... };
         }
+        _registry.get().index_update(_entity);
         return *this;
     }
 
@@ -55,6 +55,29 @@ private:
     std::string _msg;
 };
 
+/// @brief Exception raised when looking up a key in an index that was not added
+class index_not_found : public std::exception {
+public:
+    /// @brief Construct a new index not found exception object
+    ///
+    /// @param meta Type metadata of the indexed component
+    explicit index_not_found(const type_meta* meta) {
+        std::stringstream ss;
+        ss << "index on component \"" << meta->name << "\" with the requested key type not found";
+        _msg = ss.str();
+    }
+
+    /// @brief Message to the client
+    ///
+    /// @return const char*
+    [[nodiscard]] auto what() const noexcept -> const char* override {
+        return _msg.c_str();
+    }
+
+private:
+    std::string _msg;
+};
+
 /// @brief Insufficient chunk size error
 class insufficient_chunk_size : public std::exception {
 public:
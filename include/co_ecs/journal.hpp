@@ -0,0 +1,228 @@
+#pragma once
+
+#include <co_ecs/command.hpp>
+#include <co_ecs/command_log.hpp>
+#include <co_ecs/detail/append_file.hpp>
+#include <co_ecs/registry.hpp>
+
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace co_ecs {
+
+/// @brief Write-ahead journal of the changes made to a registry since its last snapshot.
+///
+/// The journal records the commands played by command_buffer::flush and, on every commit(), the rows of chunks whose
+/// change version moved since the previous commit. Committed frames are handed to a background thread which appends
+/// them to the file and syncs it, the simulation thread only encodes and never waits for the disk. A crash loses at
+/// most the frames the writer has not synced yet.
+///
+/// Start a journal right after saving a snapshot, recovery loads the snapshot and replays the complete frames of the
+/// journal on top of it with command_log_player. Entities created or destroyed directly through the registry instead
+/// of command buffers are not journaled, neither are components without a registered serializer.
+///
+/// @code
+/// save_snapshot(registry, "world.snapshot");
+/// co_ecs::journal journal{ registry, "world.journal" };
+///
+/// while (running) {
+///     executor->run_once();
+///     journal.commit(registry);
+/// }
+///
+/// // after a crash
+/// auto recovered = load_snapshot("world.snapshot");
+/// std::ifstream file("world.journal", std::ios::binary);
+/// co_ecs::command_log_player player{ co_ecs::journal::recover(file) };
+/// while (player.next_frame(recovered)) {
+/// }
+/// @endcode
+///
+/// @note Serializers have to be registered before the journal starts. The journal installs its command log with
+/// command_buffer::set_log(), commit must not run concurrently with systems or command buffer flushes and must run
+/// before chunk_compressor::sweep, compressed chunks are not read.
+class journal {
+public:
+    /// @brief Construct a new journal, truncates the file and takes the current state of the registry as the base
+    ///
+    /// @param registry Registry
+    /// @param path Journal file path
+    journal(const registry& registry, const std::string& path) : _file(path) {
+        scan(registry, false);
+        _log.begin_frame();
+        command_buffer::set_log(&_log);
+        _writer = std::thread([this]() { write_loop(); });
+    }
+
+    journal(const journal&) = delete;
+    journal& operator=(const journal&) = delete;
+
+    /// @brief Write and sync all committed frames and stop the writer
+    ~journal() {
+        command_buffer::set_log(nullptr);
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        _writer.join();
+    }
+
+    /// @brief Record changed rows and hand the frame to the writer thread
+    ///
+    /// @param registry Registry
+    void commit(const registry& registry) {
+        scan(registry, true);
+
+        std::unique_lock lock(_mutex);
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+        // each frame is prefixed with its size so recovery can drop a frame torn by a crash
+        auto size_offset = _pending.size();
+        _pending.resize(size_offset + sizeof(std::uint64_t));
+        _log.drain(_pending);
+        std::uint64_t size = _pending.size() - size_offset - sizeof(std::uint64_t);
+        std::memcpy(_pending.data() + size_offset, &size, sizeof(size));
+        _committed++;
+        lock.unlock();
+        _cv.notify_all();
+
+        _log.begin_frame();
+    }
+
+    /// @brief Block until every committed frame is synced
+    void wait() {
+        std::unique_lock lock(_mutex);
+        _cv.wait(lock, [this]() { return _durable == _committed || _error; });
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+    /// @brief Get number of frames synced to the file
+    ///
+    /// @return std::uint64_t Number of frames
+    [[nodiscard]] auto durable() const -> std::uint64_t {
+        std::lock_guard lock(_mutex);
+        return _durable;
+    }
+
+    /// @brief Read the complete frames of a journal, a frame torn by a crash is dropped
+    ///
+    /// @param in Journal file
+    /// @return std::vector<std::byte> Command log bytes for command_log_player
+    [[nodiscard]] static auto recover(std::istream& in) -> std::vector<std::byte> {
+        auto bytes = command_log::load(in);
+        std::vector<std::byte> log;
+        std::size_t offset{};
+        while (bytes.size() - offset >= sizeof(std::uint64_t)) {
+            std::uint64_t size{};
+            std::memcpy(&size, bytes.data() + offset, sizeof(size));
+            offset += sizeof(size);
+            if (bytes.size() - offset < size) {
+                break;
+            }
+            log.insert(log.end(), bytes.begin() + offset, bytes.begin() + offset + size);
+            offset += size;
+        }
+        return log;
+    }
+
+private:
+    // compares chunk versions with the ones seen by the previous scan, like chunk_compressor
+    void scan(const registry& registry, bool record) {
+        const auto& archetypes = registry.archetypes();
+        _versions.resize(archetypes.size());
+
+        for (std::size_t archetype_index = 0; archetype_index < archetypes.size(); archetype_index++) {
+            const auto& chunks = archetypes.by_index(archetype_index)->chunks();
+            auto& versions = _versions[archetype_index];
+            versions.resize(chunks.size());
+
+            for (std::size_t chunk_index = 0; chunk_index < chunks.size(); chunk_index++) {
+                const auto& chunk = chunks[chunk_index];
+                if (versions[chunk_index] == chunk.version() || chunk.compressed()) {
+                    continue;
+                }
+                versions[chunk_index] = chunk.version();
+                if (!record) {
+                    continue;
+                }
+                auto entities = chunk.entities();
+                chunk.visit_columns([&](const_component_column column) {
+                    if (!serializable(column.meta)) {
+                        return;
+                    }
+                    for (std::size_t index = 0; index < column.count; index++) {
+                        _log.set(column.meta, column.at(index), entities[index]);
+                    }
+                });
+            }
+        }
+    }
+
+    auto serializable(component_meta meta) -> bool {
+        if (_serializable.size() <= meta.id) {
+            _serializable.resize(meta.id + 1, serializable_state::unknown);
+        }
+        auto& state = _serializable[meta.id];
+        if (state == serializable_state::unknown) {
+            state = component_serializers::find(meta.id) ? serializable_state::yes : serializable_state::no;
+        }
+        return state == serializable_state::yes;
+    }
+
+    void write_loop() {
+        std::vector<std::byte> frames;
+        std::unique_lock lock(_mutex);
+        while (true) {
+            _cv.wait(lock, [this]() { return _stop || !_pending.empty(); });
+            if (_pending.empty() && _stop) {
+                return;
+            }
+
+            // batch everything committed so far into one write and one sync
+            std::swap(frames, _pending);
+            auto committed = _committed;
+            lock.unlock();
+            try {
+                _file.write(frames);
+                _file.sync();
+            } catch (...) {
+                lock.lock();
+                _error = std::current_exception();
+                _cv.notify_all();
+                return;
+            }
+            frames.clear();
+            lock.lock();
+            _durable = committed;
+            _cv.notify_all();
+        }
+    }
+
+    enum class serializable_state : std::uint8_t { unknown, yes, no };
+
+    command_log _log;
+    std::vector<std::vector<std::uint64_t>> _versions;
+    std::vector<serializable_state> _serializable; ///< Serializer lookups by component ID
+
+    detail::append_file _file;
+    std::thread _writer;
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    std::vector<std::byte> _pending;
+    std::uint64_t _committed{};
+    std::uint64_t _durable{};
+    std::exception_ptr _error;
+    bool _stop{};
+};
+
+} // namespace co_ecs
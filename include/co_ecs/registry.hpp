@@ -40,6 +40,23 @@ public:
         return get_entity(create_impl(std::forward<Components>(args)...));
     }
 
+    /// @brief Creates a new entity, components passed as in_place<C>(args...) are constructed directly in the chunk
+    /// row instead of being moved from a temporary, which matters for large components. Plain component values can be
+    /// mixed in.
+    ///
+    /// @code
+    /// auto entity = registry.create(co_ecs::in_place<mesh>(vertices, 1024), position{ 1, 2 });
+    /// @endcode
+    ///
+    /// @tparam Args Component values or in_place_t arguments, at least one in_place_t
+    /// @param args Components to attach.
+    /// @return entity_ref A reference to the newly created entity, allowing further operations.
+    template<component_argument... Args>
+        requires(in_place_construction<Args> || ...)
+    constexpr auto create(Args&&... args) -> entity_ref {
+        return get_entity(create_impl(std::forward<Args>(args)...));
+    }
+
     /// @brief Retrieves a mutable reference to an entity.
     ///
     /// This method returns a mutable reference to the specified entity from the registry.
@@ -55,6 +55,45 @@ public:
         return true;
     }
 
+    /// @brief Checks if this access pattern conflicts with another one, in either direction.
+    ///
+    /// Unlike allows(), which answers whether a system may join a batch with this accumulated access pattern, the
+    /// check is symmetric and treats registry wide access as access to every component.
+    ///
+    /// @param other The other access pattern to check against.
+    /// @return True if one of the patterns writes anything the other one accesses.
+    [[nodiscard]] auto conflicts(const access_pattern_t& other) const noexcept -> bool {
+        if ((writes_all() && !other.empty()) || (other.writes_all() && !empty())) {
+            return true;
+        }
+        if ((reads_all() && other.writes_any()) || (other.reads_all() && writes_any())) {
+            return true;
+        }
+
+        for (auto [component_id, access] : _component_access) {
+            if ((access == access_type::write && other.reads(component_id)) || other.writes(component_id)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// @brief Checks if this access pattern does not access anything.
+    ///
+    /// @return True if neither the registry nor any component is accessed.
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return _registry_access == access_type::none && _component_access.empty();
+    }
+
+    /// @brief Checks if this access pattern writes to any component.
+    ///
+    /// @return True if the registry or at least one component is written.
+    [[nodiscard]] auto writes_any() const noexcept -> bool {
+        return writes_all()
+            || std::ranges::any_of(_component_access, [](auto entry) { return entry.second == access_type::write; });
+    }
+
     /// @brief Checks if this access pattern writes to all components.
     ///
     /// @return True if this access pattern writes to all components, false otherwise.
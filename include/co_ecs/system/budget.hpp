@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+namespace co_ecs {
+
+/// @brief Per frame budget of a time sliced system.
+///
+/// A system with a budget processes chunks until either limit is reached and continues from where it stopped on the
+/// next run. At least one chunk is processed per run so the system always makes progress.
+///
+/// @code
+/// schedule.begin_stage()
+///     .add_system(co_ecs::system_budget{ .time = std::chrono::microseconds{ 500 } }, rebuild_navmesh)
+///     .end_stage();
+/// @endcode
+struct system_budget {
+    /// @brief Maximum time spent per run
+    std::chrono::nanoseconds time{ std::chrono::nanoseconds::max() };
+
+    /// @brief Maximum number of chunks processed per run
+    std::size_t chunks{ std::numeric_limits<std::size_t>::max() };
+};
+
+/// @brief Budget consumed by a single run of a time sliced system
+struct budget_usage {
+    /// @brief Time spent
+    std::chrono::nanoseconds time{};
+
+    /// @brief Number of chunks processed
+    std::size_t chunks{};
+
+    /// @brief Whether the run stopped because the budget was exhausted
+    bool exhausted{};
+};
+
+/// @brief Tracks budget consumption of the system running on the current thread.
+///
+/// A tracker installs itself as the current one for its lifetime, time sliced iteration consults the current tracker
+/// before processing each chunk.
+class budget_tracker {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    /// @brief Start tracking budget consumption on the current thread
+    ///
+    /// @param budget Budget
+    explicit budget_tracker(const system_budget& budget) noexcept :
+        _budget(budget), _start(clock_type::now()), _outer(std::exchange(current_tracker, this)) {
+    }
+
+    /// @brief Stop tracking, restores the previously installed tracker
+    ~budget_tracker() {
+        current_tracker = _outer;
+    }
+
+    budget_tracker(const budget_tracker&) = delete;
+    budget_tracker& operator=(const budget_tracker&) = delete;
+
+    /// @brief Get the tracker of the current thread
+    ///
+    /// @return Tracker pointer or nullptr when no budget is tracked
+    [[nodiscard]] static budget_tracker* current() noexcept {
+        return current_tracker;
+    }
+
+    /// @brief Try to consume budget for a single chunk
+    ///
+    /// @return True when the chunk may be processed, false when the budget is exhausted
+    [[nodiscard]] auto try_consume() noexcept -> bool {
+        if (_chunks > 0 && (_chunks >= _budget.chunks || elapsed() >= _budget.time)) {
+            _exhausted = true;
+            return false;
+        }
+        _chunks++;
+        return true;
+    }
+
+    /// @brief Get the budget consumed so far
+    ///
+    /// @return Budget usage
+    [[nodiscard]] auto usage() const noexcept -> budget_usage {
+        return budget_usage{ elapsed(), _chunks, _exhausted };
+    }
+
+private:
+    [[nodiscard]] auto elapsed() const noexcept -> std::chrono::nanoseconds {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - _start);
+    }
+
+    static inline thread_local budget_tracker* current_tracker;
+
+    system_budget _budget;
+    clock_type::time_point _start;
+    budget_tracker* _outer;
+    std::size_t _chunks{};
+    bool _exhausted{};
+};
+
+} // namespace co_ecs
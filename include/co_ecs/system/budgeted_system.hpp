@@ -0,0 +1,81 @@
+#pragma once
+
+#include <co_ecs/system/budget.hpp>
+#include <co_ecs/system/profiler.hpp>
+#include <co_ecs/system/system.hpp>
+
+namespace co_ecs {
+
+/// @brief System decorator running the executors of a system within a budget and reporting the consumed budget to the
+/// profiler
+class budgeted_system : public system_interface {
+public:
+    /// @brief Executor running the wrapped executor within a budget
+    class executor : public system_executor_interface {
+    public:
+        /// @brief Construct a new executor object
+        ///
+        /// @param inner Wrapped executor
+        /// @param budget Budget per run
+        executor(std::unique_ptr<system_executor_interface> inner, system_budget budget) :
+            _inner(std::move(inner)), _budget(budget) {
+        }
+
+        /// @brief Execute system logic within the budget
+        void run() override {
+            budget_tracker tracker{ _budget };
+            _inner->run();
+            if (auto* instance = profiler::get()) {
+                instance->report_budget(name().empty() ? type_name() : name(), tracker.usage());
+            }
+        }
+
+        /// @brief Get the name of the entity.
+        ///
+        /// @return The name of the entity.
+        auto name() const -> std::string_view override {
+            return _inner->name();
+        }
+
+        /// @brief Get the type name of the entity.
+        ///
+        /// @return The type name of the entity.
+        auto type_name() const -> std::string_view override {
+            return _inner->type_name();
+        }
+
+        /// @brief Get the access pattern of the entity.
+        ///
+        /// @return The access pattern of the entity.
+        auto access_pattern() const -> access_pattern_t override {
+            return _inner->access_pattern();
+        }
+
+    private:
+        std::unique_ptr<system_executor_interface> _inner;
+        system_budget _budget;
+    };
+
+    /// @brief Construct a new budgeted system object
+    ///
+    /// @param inner Wrapped system
+    /// @param budget Budget per run
+    budgeted_system(std::unique_ptr<system_interface> inner, system_budget budget) :
+        _inner(std::move(inner)), _budget(budget) {
+    }
+
+    /// @brief Create an executor object
+    ///
+    /// @param registry Registry reference
+    /// @param user_context User provided context to fetch data from and provide to the system
+    /// @return Executor object
+    std::unique_ptr<system_executor_interface> create_executor(registry& registry, void* user_context) override {
+        return std::make_unique<executor>(_inner->create_executor(registry, user_context), _budget);
+    }
+
+private:
+    std::unique_ptr<system_interface> _inner;
+    system_budget _budget;
+};
+
+} // namespace co_ecs
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <co_ecs/system/profiler.hpp>
+#include <co_ecs/system/schedule.hpp>
+
+#include <deque>
+#include <functional>
+#include <optional>
+
+namespace co_ecs {
+
+/// @brief Pipeline statistics
+struct pipeline_stats {
+    /// @brief Number of snapshots still being consumed, including the one submitted last
+    std::size_t depth{};
+
+    /// @brief Number of frames run so far
+    std::uint64_t frames{};
+
+    /// @brief Number of times simulation had to wait for consumers of an older frame
+    std::uint64_t stalls{};
+};
+
+/// @brief Executor overlapping the simulation of frame N+1 with read-only consumers of frame N.
+///
+/// After every simulation frame the registry is extracted into a snapshot, consumers then read that snapshot on the
+/// thread pool while run_once() returns and the next frame is simulated. Consumers never touch the registry, which is
+/// mutated concurrently, only the snapshot. Up to max_depth snapshots are in flight, when the oldest one is still
+/// being consumed the next extraction waits for it, which is reported as a stall.
+///
+/// @code
+/// struct render_snapshot {
+///     std::vector<transform> transforms;
+/// };
+///
+/// co_ecs::pipelined_executor<render_snapshot> pipeline(
+///     registry,
+///     schedule.create_executor(registry),
+///     [](const co_ecs::registry& registry, render_snapshot& snapshot) {
+///         co_ecs::view<const transform&>{ registry }.par_extract(snapshot.transforms);
+///     });
+/// pipeline.add_consumer([&renderer](const render_snapshot& snapshot) { renderer.draw(snapshot.transforms); });
+///
+/// while (running) {
+///     pipeline.run_once();
+/// }
+/// @endcode
+///
+/// @tparam Snapshot Type holding the data extracted for consumers
+template<typename Snapshot>
+class pipelined_executor {
+public:
+    /// @brief Function filling a snapshot from the registry
+    using extract_func = std::function<void(const registry&, Snapshot&)>;
+
+    /// @brief Function consuming a snapshot
+    using consumer_func = std::function<void(const Snapshot&)>;
+
+    /// @brief Constructs a pipelined executor.
+    ///
+    /// @param registry Reference to the registry the simulation runs on.
+    /// @param simulation Executor of the simulation stages.
+    /// @param extract Function filling a snapshot from the registry.
+    /// @param max_depth Maximum number of snapshots in flight.
+    pipelined_executor(registry& registry,
+        std::unique_ptr<schedule_executor> simulation,
+        extract_func extract,
+        std::size_t max_depth = 2) :
+        _registry(registry),
+        _simulation(std::move(simulation)),
+        _extract(std::move(extract)),
+        _slots(std::max<std::size_t>(max_depth, 1)) {
+    }
+
+    /// @brief Waits for in-flight consumers.
+    ~pipelined_executor() {
+        wait();
+    }
+
+    pipelined_executor(const pipelined_executor&) = delete;
+    pipelined_executor& operator=(const pipelined_executor&) = delete;
+
+    /// @brief Adds a consumer. Consumers of a snapshot run in parallel with each other and with the simulation.
+    ///
+    /// @param consumer Function consuming a snapshot.
+    /// @return Reference to this executor.
+    auto add_consumer(consumer_func consumer) -> pipelined_executor& {
+        _consumers.emplace_back(std::move(consumer));
+        return *this;
+    }
+
+    /// @brief Simulates one frame, extracts a snapshot and submits consumers for it without waiting for them.
+    void run_once() {
+        _simulation->run_once();
+
+        auto& slot = _slots[_stats.frames % _slots.size()];
+        if (slot.root && !slot.root->is_completed()) {
+            _stats.stalls++;
+            thread_pool::get().wait(&*slot.root);
+        }
+
+        _extract(std::as_const(_registry), slot.snapshot);
+
+        // consumer tasks outlive this call, they are owned by the slot instead of the task pool of this thread which
+        // reuses its slots after a few thousand allocations
+        auto& pool = thread_pool::get();
+        slot.tasks.clear();
+        // the root is released only after every consumer is attached to it, so it cannot complete early
+        slot.root.emplace([]() {});
+        for (auto& consumer : _consumers) {
+            pool.submit(&slot.tasks.emplace_back(
+                [&consumer, &snapshot = slot.snapshot]() { consumer(snapshot); }, &*slot.root));
+        }
+        slot.root->execute();
+
+        _stats.frames++;
+        _stats.depth = in_flight();
+
+        if (auto* instance = profiler::get()) {
+            instance->report_pipeline(_stats);
+        }
+    }
+
+    /// @brief Waits until consumers of every submitted snapshot finish.
+    void wait() {
+        for (auto& slot : _slots) {
+            if (slot.root) {
+                thread_pool::get().wait(&*slot.root);
+            }
+        }
+        _stats.depth = 0;
+    }
+
+    /// @brief Get pipeline statistics
+    ///
+    /// @return Statistics
+    [[nodiscard]] auto stats() const noexcept -> const pipeline_stats& {
+        return _stats;
+    }
+
+private:
+    struct slot {
+        Snapshot snapshot{};
+        std::optional<task_t> root;
+        std::deque<task_t> tasks;
+    };
+
+    [[nodiscard]] auto in_flight() const noexcept -> std::size_t {
+        return std::ranges::count_if(_slots, [](const slot& s) { return s.root && !s.root->is_completed(); });
+    }
+
+    registry& _registry;
+    std::unique_ptr<schedule_executor> _simulation;
+    extract_func _extract;
+    std::vector<consumer_func> _consumers;
+    std::vector<slot> _slots;
+    pipeline_stats _stats;
+};
+
+} // namespace co_ecs
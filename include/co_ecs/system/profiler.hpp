@@ -0,0 +1,70 @@
+#pragma once
+
+#include <co_ecs/system/budget.hpp>
+
+#include <atomic>
+#include <string_view>
+
+namespace co_ecs {
+
+struct pipeline_stats;
+struct stage_report;
+
+/// @brief Profiler interface, receives events from schedule executors.
+///
+/// Install a profiler with profiler::set(), executors report to it from the threads systems are executed on, so
+/// implementations have to be thread safe.
+///
+/// @code
+/// struct budget_logger : co_ecs::profiler {
+///     void report_budget(std::string_view system, const co_ecs::budget_usage& usage) override {
+///         std::cout << system << ": " << usage.chunks << " chunks\n";
+///     }
+/// };
+///
+/// budget_logger logger;
+/// co_ecs::profiler::set(&logger);
+/// @endcode
+class profiler {
+public:
+    /// @brief Destroy the profiler object
+    virtual ~profiler() = default;
+
+    /// @brief Report budget consumed by a single run of a time sliced system
+    ///
+    /// @param system Name of the system
+    /// @param usage Consumed budget
+    virtual void report_budget([[maybe_unused]] std::string_view system, [[maybe_unused]] const budget_usage& usage) {
+    }
+
+    /// @brief Report pipeline statistics after a frame of a pipelined executor
+    ///
+    /// @param stats Pipeline statistics
+    virtual void report_pipeline([[maybe_unused]] const pipeline_stats& stats) {
+    }
+
+    /// @brief Report predicted and measured makespan of an auto tuned stage after its batches were recomputed
+    ///
+    /// @param report Stage report
+    virtual void report_stage([[maybe_unused]] const stage_report& report) {
+    }
+
+    /// @brief Install a profiler
+    ///
+    /// @param instance Profiler pointer or nullptr to disable profiling
+    static void set(profiler* instance) noexcept {
+        _instance.store(instance, std::memory_order::release);
+    }
+
+    /// @brief Get installed profiler
+    ///
+    /// @return Profiler pointer or nullptr when no profiler is installed
+    [[nodiscard]] static auto get() noexcept -> profiler* {
+        return _instance.load(std::memory_order::acquire);
+    }
+
+private:
+    static inline std::atomic<profiler*> _instance{};
+};
+
+} // namespace co_ecs
@@ -6,6 +6,11 @@
 #include <co_ecs/system/stage.hpp>
 #include <co_ecs/system/system.hpp>
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
 namespace co_ecs {
 
 class schedule_executor;
@@ -39,6 +44,46 @@ public:
         return _stages.emplace_back(*this, name);
     }
 
+    /// @brief Enables or disables deterministic command merging.
+    ///
+    /// In deterministic mode commands recorded by systems are played in the schedule order of the systems instead of
+    /// the order worker threads registered their command buffers, so the resulting world does not depend on the number
+    /// of workers. Combine it with fixed partitioning in parallel reductions, see view::par_reduce.
+    ///
+    /// @param enabled Whether deterministic mode is enabled.
+    /// @return Reference to this schedule object.
+    auto deterministic(bool enabled = true) -> self_type& {
+        _flush_order = enabled ? flush_order::deterministic : flush_order::registration;
+        return *this;
+    }
+
+    /// @brief Enables or disables automatic sync points.
+    ///
+    /// By default commands recorded by systems are flushed once at the end of schedule_executor::run_once(), so
+    /// entities spawned by a system are visible to other systems on the next run only. With sync points enabled
+    /// pending commands are flushed right before the first batch containing a system that accesses a component
+    /// affected by them, see stage_executor::auto_sync(). Systems not touching those components do not cause a flush.
+    ///
+    /// @param enabled Whether sync points are enabled.
+    /// @return Reference to this schedule object.
+    auto auto_sync(bool enabled = true) -> self_type& {
+        _auto_sync = enabled;
+        return *this;
+    }
+
+    /// @brief Enables auto tuning of stage batches from measured system costs.
+    ///
+    /// Every stage measures its systems and recomputes its batches once per window of runs so that systems on the
+    /// critical path start as early as their conflicts allow, see stage_executor. Reports are available through
+    /// schedule_executor::reports() and are sent to the installed profiler.
+    ///
+    /// @param window Number of runs costs are averaged over, 0 disables tuning.
+    /// @return Reference to this schedule object.
+    auto auto_tune(std::size_t window = default_tuning_window) -> self_type& {
+        _tuning_window = window;
+        return *this;
+    }
+
     /// @brief Creates an executor for the schedule.
     ///
     /// This function creates a schedule executor, which is responsible for running the stages of the schedule.
@@ -47,18 +92,125 @@ public:
     /// @param user_context Optional user context.
     /// @return Unique pointer to the created schedule executor.
     auto create_executor(registry& registry, void* user_context = nullptr) -> std::unique_ptr<schedule_executor> {
+        auto* sync_registry = _auto_sync ? &registry : nullptr;
+
         std::vector<std::unique_ptr<stage_executor>> stage_executors;
         for (auto& stage : _stages) {
-            stage_executors.emplace_back(stage.create_executor(registry, user_context));
+            auto& executor = stage_executors.emplace_back(stage.create_executor(registry, user_context));
+            executor->auto_tune(_tuning_window);
+            executor->auto_sync(sync_registry, _flush_order);
         }
 
-        return std::make_unique<schedule_executor>(
-            registry, std::move(stage_executors), _init_stage.create_executor(registry, user_context));
+        auto init = _init_stage.create_executor(registry, user_context);
+        init->auto_sync(sync_registry, _flush_order);
+
+        return std::make_unique<schedule_executor>(registry, std::move(stage_executors), std::move(init), _flush_order);
     }
 
+    /// @brief Default number of runs stage costs are averaged over
+    static constexpr std::size_t default_tuning_window = 60;
+
 private:
     stage _init_stage{ *this };
     std::vector<stage> _stages;
+    flush_order _flush_order{ flush_order::registration };
+    std::size_t _tuning_window{};
+    bool _auto_sync{};
+};
+
+/// @brief Handle to a frame submitted with schedule_executor::run_async().
+///
+/// The handle is cheap to copy, every copy refers to the same frame. A frame that runs main thread systems needs the
+/// main thread to help, either by waiting or by polling.
+///
+/// @code
+/// auto frame = executor->run_async().then([&]() { server.publish_state(); });
+///
+/// while (!frame.poll()) {
+///     server.service_io();
+/// }
+/// @endcode
+class frame_handle {
+public:
+    /// @brief Constructs an empty handle, refers to no frame and is always ready.
+    frame_handle() = default;
+
+    /// @brief Checks whether the frame and its continuations have finished.
+    ///
+    /// @return True if the frame is complete.
+    [[nodiscard]] auto ready() const noexcept -> bool {
+        return !_state || _state->root.is_completed();
+    }
+
+    /// @brief Runs at most one pending task on the calling thread, tasks queued for the main thread first when called
+    /// from the main thread, then checks whether the frame has finished.
+    ///
+    /// @return True if the frame is complete.
+    auto poll() -> bool {
+        if (!ready()) {
+            thread_pool::get().run_pending_task();
+        }
+        return ready();
+    }
+
+    /// @brief Waits for the frame to finish, the calling thread executes tasks in the meantime.
+    void wait() {
+        if (_state) {
+            thread_pool::get().wait(&_state->root);
+        }
+    }
+
+    /// @brief Adds a continuation run after the frame and the continuations added before it. The continuation runs on
+    /// the thread that finished the frame, or right away on the calling thread when the frame is already complete.
+    ///
+    /// @param func Continuation, must not wait for the frame it is attached to.
+    /// @return Reference to this handle.
+    auto then(std::function<void()> func) -> frame_handle& {
+        if (!_state) {
+            func();
+            return *this;
+        }
+        {
+            std::lock_guard lock(_state->mutex);
+            if (!_state->finished) {
+                _state->continuations.emplace_back(std::move(func));
+                return *this;
+            }
+        }
+        func();
+        return *this;
+    }
+
+private:
+    friend class schedule_executor;
+
+    /// @brief Shared state of a frame, the root and frame tasks are owned here so they outlive the task pool slots of
+    /// the threads submitting and polling them.
+    struct frame_state {
+        task_t root{ []() {} };
+        std::optional<task_t> frame;
+        std::mutex mutex;
+        std::vector<std::function<void()>> continuations;
+        bool finished{};
+
+        /// @brief Marks the frame finished and runs continuations added so far
+        void finish() {
+            std::vector<std::function<void()>> continuations;
+            {
+                std::lock_guard lock(mutex);
+                finished = true;
+                continuations.swap(this->continuations);
+            }
+            for (auto& continuation : continuations) {
+                continuation();
+            }
+        }
+    };
+
+    explicit frame_handle(std::shared_ptr<frame_state> state) noexcept : _state(std::move(state)) {
+    }
+
+    std::shared_ptr<frame_state> _state;
 };
 
 /// @class schedule_executor
@@ -73,33 +225,99 @@ public:
     /// @param registry Reference to the registry object.
     /// @param stages Vector of unique pointers to stage executors.
     /// @param init Unique pointer to the initial stage executor.
+    /// @param order Order in which recorded commands are flushed.
     schedule_executor(registry& registry,
         std::vector<std::unique_ptr<stage_executor>> stages,
-        std::unique_ptr<stage_executor> init) :
-        _registry(registry), _stages(std::move(stages)), _init(std::move(init)) {
+        std::unique_ptr<stage_executor> init,
+        flush_order order = flush_order::registration) :
+        _registry(registry), _stages(std::move(stages)), _init(std::move(init)), _flush_order(order) {
         // Run initial systems
         _init->run();
 
         // Flush commands
-        command_buffer::flush(_registry);
+        command_buffer::flush(_registry, _flush_order);
     }
 
+    /// @brief Waits for the frame submitted last with run_async(), if any.
+    ~schedule_executor() {
+        _frame.wait();
+    }
+
+    schedule_executor(const schedule_executor&) = delete;
+    schedule_executor& operator=(const schedule_executor&) = delete;
+
     /// @brief Executes the schedule once.
     ///
-    /// This function runs all stages in the schedule and then flushes the command buffer.
+    /// This function runs all stages in the schedule and then flushes the command buffer. A frame submitted with
+    /// run_async() is waited for first.
     void run_once() {
+        _frame.wait();
+        run_stages();
+    }
+
+    /// @brief Submits a frame to the thread pool and returns without waiting for it.
+    ///
+    /// The frame runs all stages and flushes the command buffer like run_once(). The registry must not be accessed
+    /// until the frame is complete. A frame submitted before is waited for first, so at most one frame is in flight.
+    ///
+    /// @return Handle to wait for, poll or chain continuations to the frame.
+    [[nodiscard]] auto run_async() -> frame_handle {
+        _frame.wait();
+
+        auto state = std::make_shared<frame_handle::frame_state>();
+        // the root is released only after the frame is attached to it, so it cannot complete early
+        state->frame.emplace(
+            [this, state = state.get()]() {
+                run_stages();
+                state->finish();
+            },
+            &state->root);
+        thread_pool::get().submit(&*state->frame);
+        state->root.execute();
+
+        _frame = frame_handle{ std::move(state) };
+        return _frame;
+    }
+
+    /// @brief Returns the number of sync points inserted so far by all stages.
+    ///
+    /// @return Number of flushes done before a batch, the flush at the end of every run is not counted.
+    [[nodiscard]] auto sync_points() const noexcept -> std::uint64_t {
+        std::uint64_t sync_points{};
+        for (const auto& stage : _stages) {
+            sync_points += stage->sync_points();
+        }
+        return sync_points;
+    }
+
+    /// @brief Returns the reports of the last retune of every stage, in stage order.
+    ///
+    /// @return Stage reports, empty reports for stages that have not been retuned yet.
+    [[nodiscard]] auto reports() const -> std::vector<stage_report> {
+        std::vector<stage_report> reports;
+        reports.reserve(_stages.size());
+        for (const auto& stage : _stages) {
+            reports.push_back(stage->report());
+        }
+        return reports;
+    }
+
+private:
+    /// @brief Runs all stages and flushes commands.
+    void run_stages() {
         for (auto& stage : _stages) {
             stage->run();
         }
 
         // Flush commands
-        command_buffer::flush(_registry);
+        command_buffer::flush(_registry, _flush_order);
     }
 
-private:
     registry& _registry;
     std::vector<std::unique_ptr<stage_executor>> _stages;
     std::unique_ptr<stage_executor> _init;
+    flush_order _flush_order;
+    frame_handle _frame;
 };
 
 } // namespace co_ecs
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <co_ecs/system/budget.hpp>
+#include <co_ecs/system/system.hpp>
+
+namespace co_ecs {
+
+/// @brief A view that iterates chunks within the budget of the running system and resumes where it stopped on the
+/// next call.
+///
+/// The position is kept as a pair of an archetype index, which never changes for an archetype, and a chunk index
+/// within that archetype, so it stays valid when archetypes are created or chunks are added and removed in between.
+/// Entities moved between chunks in between calls may be visited twice or skipped in that pass.
+///
+/// @code
+/// schedule.begin_stage()
+///     .add_system(co_ecs::system_budget{ .chunks = 4 }, [](co_ecs::sliced_view<navmesh_tile&>& tiles) {
+///         tiles.each([](navmesh_tile& tile) { tile.rebuild(); });
+///     })
+///     .end_stage();
+/// @endcode
+///
+/// @tparam Args Component reference types
+template<component_reference... Args>
+class sliced_view {
+private:
+    /// @brief Indicates if the view is const when all component references are const.
+    static constexpr bool is_const = detail::view_arguments<Args...>::is_const;
+
+    /// @brief The type of the registry, deduced based on the input component reference types.
+    using registry_type = std::conditional_t<is_const, const registry&, registry&>;
+
+public:
+    /// @brief Constructs a new sliced view object.
+    /// @param registry Reference to the registry.
+    explicit sliced_view(registry_type registry) noexcept : _registry(registry) {
+    }
+
+    /// @brief Runs a function on entities that match the Args requirement until the budget of the current thread is
+    /// exhausted. Without a budget the remaining part of the pass is processed at once.
+    ///
+    /// @param func A callable to run on entity components.
+    /// @return True when the pass over all entities has been completed, the next call starts a new pass.
+    auto each(auto&& func) -> bool {
+        auto* tracker = budget_tracker::current();
+        auto& archetypes = _registry.archetypes();
+
+        for (; _archetype_index < archetypes.size(); _archetype_index++, _chunk_index = 0) {
+            auto* archetype = archetypes.by_index(_archetype_index);
+            if (!(match<decay_component_t<Args>>(archetype) && ...)) {
+                continue;
+            }
+
+            auto& chunks = archetype->chunks();
+            for (; _chunk_index < chunks.size(); _chunk_index++) {
+                if (chunks[_chunk_index].empty()) {
+                    continue;
+                }
+                if (tracker && !tracker->try_consume()) {
+                    return false;
+                }
+                for (auto entry : chunk_view<Args...>(chunks[_chunk_index])) {
+                    std::apply(func, entry);
+                }
+            }
+        }
+
+        reset();
+        return true;
+    }
+
+    /// @brief Restart iteration from the beginning on the next call to each().
+    void reset() noexcept {
+        _archetype_index = 0;
+        _chunk_index = 0;
+    }
+
+private:
+    template<component C>
+    constexpr static bool match(auto* archetype) {
+        if constexpr (std::is_same_v<C, entity>) {
+            return true;
+        } else {
+            return archetype->template contains<C>();
+        }
+    }
+
+    registry_type _registry; ///< Reference to the registry.
+    std::size_t _archetype_index{};
+    std::size_t _chunk_index{};
+};
+
+/// @cond TURN_OFF_DOXYGEN
+
+/// @brief System sliced view state, keeps the sliced view and its position between runs
+///
+/// @tparam Args View argument types
+template<component_reference... Args>
+class system_sliced_view_state {
+public:
+    /// @brief Construct a new system sliced view state object
+    ///
+    /// @param registry Registry reference
+    /// @param user_context User provided context to fetch data from and provide to the system
+    explicit system_sliced_view_state(registry& registry, [[maybe_unused]] void* user_context) noexcept :
+        _view(registry) {
+    }
+
+    /// @brief Returns the actual state inside to pass to the system
+    ///
+    /// @return Sliced view object
+    [[nodiscard]] sliced_view<Args...>& get() noexcept {
+        return _view;
+    }
+
+    /// @brief Get the access pattern of the entity.
+    ///
+    /// @return The access pattern of the entity.
+    auto access_pattern() const -> access_pattern_t {
+        return (access_pattern_t(
+                    std::is_const_v<std::remove_reference_t<Args>> ? access_type::read : access_type::write,
+                    component_meta::of<decay_component_t<Args>>())
+                & ...);
+    }
+
+private:
+    sliced_view<Args...> _view;
+};
+
+/// @brief Specialization for ecs::sliced_view<Args...>, taken by reference since the view keeps its position
+///
+/// @tparam Args View argument types
+template<component_reference... Args>
+class system_argument_state_trait<sliced_view<Args...>&> {
+public:
+    /// @brief Actual state type for T
+    using state_type = system_sliced_view_state<Args...>;
+};
+
+/// @endcond TURN_OFF_DOXYGEN
+
+} // namespace co_ecs
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <co_ecs/system/budgeted_system.hpp>
+#include <co_ecs/system/sliced_view.hpp>
 #include <co_ecs/system/system.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
 namespace co_ecs {
 
 /// @brief Vector of systems.
@@ -55,6 +61,20 @@ public:
         return *this;
     }
 
+    /// @brief Adds a time sliced system to the stage.
+    ///
+    /// The system runs within the budget every time the stage runs, sliced_view arguments of the system stop iterating
+    /// once the budget is exhausted and continue on the next run. Consumed budget is reported to the profiler.
+    ///
+    /// @param budget Budget per run.
+    /// @param args Arguments for the system to be added.
+    /// @return Reference to this stage object.
+    auto add_system(system_budget budget, auto&&... args) -> self_type& {
+        _systems.emplace_back(
+            std::make_unique<budgeted_system>(into_system_interface(std::forward<decltype(args)>(args)...), budget));
+        return *this;
+    }
+
     /// @brief Adds a system to the stage.
     ///
     /// @param args Arguments for the system to be added.
@@ -130,63 +150,385 @@ private:
     std::vector<std::unique_ptr<system_interface>> _main_thread_systems{};
 };
 
+namespace detail {
+
+/// @brief Places systems into batches longest first while keeping the order of conflicting systems.
+///
+/// Systems are inserted into a sequence of batches in decreasing cost. A system goes between the systems placed so far
+/// that have to run before and after it, into the earliest batch it does not conflict with, or into a new batch right
+/// after its last predecessor. Long systems are placed first, so they share batches and short systems fill the gaps
+/// around them. Whether a system has to run before another one is taken from the current batches and applies to every
+/// conflicting pair and transitively, so the relative order of conflicting systems never changes.
+///
+/// @param current Current batches of system indices.
+/// @param access Access pattern per system.
+/// @param costs Cost per system.
+/// @return New batches.
+inline auto tune_batches(const std::vector<std::vector<std::size_t>>& current,
+    const std::vector<access_pattern_t>& access,
+    const std::vector<std::chrono::nanoseconds>& costs) -> std::vector<std::vector<std::size_t>> {
+    const auto count = costs.size();
+
+    // systems in the order of their current batches, predecessors of a system are the systems that run before it and
+    // conflict with it or with any of its predecessors
+    std::vector<std::size_t> sequence;
+    for (const auto& batch : current) {
+        sequence.insert(sequence.end(), batch.begin(), batch.end());
+    }
+    std::vector<std::size_t> current_batch(count);
+    for (std::size_t batch = 0; batch < current.size(); batch++) {
+        for (auto index : current[batch]) {
+            current_batch[index] = batch;
+        }
+    }
+    std::vector<std::vector<bool>> before(count, std::vector<bool>(count));
+    for (std::size_t position = 0; position < sequence.size(); position++) {
+        auto index = sequence[position];
+        for (std::size_t previous = 0; previous < position; previous++) {
+            auto other = sequence[previous];
+            if (current_batch[other] < current_batch[index] && access[other].conflicts(access[index])) {
+                before[other][index] = true;
+                for (std::size_t transitive = 0; transitive < count; transitive++) {
+                    if (before[transitive][other]) {
+                        before[transitive][index] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), std::size_t{});
+    std::ranges::stable_sort(order, std::ranges::greater{}, [&](auto index) { return costs[index]; });
+
+    std::vector<std::vector<std::size_t>> batches;
+    std::vector<access_pattern_t> batch_access;
+    for (auto index : order) {
+        // the system goes after the last batch holding a predecessor and before the first one holding a successor
+        std::size_t first = 0;
+        auto last = batches.size();
+        for (std::size_t batch = 0; batch < batches.size(); batch++) {
+            for (auto other : batches[batch]) {
+                if (before[other][index]) {
+                    first = batch + 1;
+                }
+                if (before[index][other]) {
+                    last = std::min(last, batch);
+                }
+            }
+        }
+
+        auto batch = first;
+        while (batch < last && !batch_access[batch].allows(access[index])) {
+            batch++;
+        }
+        if (batch == last) {
+            batch = first;
+            batches.emplace(batches.begin() + static_cast<std::ptrdiff_t>(batch));
+            batch_access.emplace(batch_access.begin() + static_cast<std::ptrdiff_t>(batch));
+        }
+        batches[batch].push_back(index);
+        batch_access[batch] &= access[index];
+    }
+    return batches;
+}
+
+} // namespace detail
+
+/// @brief Report of an auto tuned stage, produced every time the stage recomputes its batches
+struct stage_report {
+    /// @brief Name of the stage
+    std::string_view name;
+
+    /// @brief Makespan of the batches that ran during the last window predicted from the measured system costs
+    std::chrono::nanoseconds predicted{};
+
+    /// @brief Average measured makespan over the last window
+    std::chrono::nanoseconds actual{};
+
+    /// @brief Makespan predicted for the recomputed batches
+    std::chrono::nanoseconds tuned{};
+
+    /// @brief Number of batches after recomputing
+    std::size_t batches{};
+
+    /// @brief Number of times batches were recomputed
+    std::uint64_t retunes{};
+};
+
 /// @brief Class representing a stage executor.
 ///
 /// A stage executor is responsible for running all systems in a stage.
+///
+/// With auto tuning enabled the executor measures every system and the stage as a whole. Once per window of runs it
+/// recomputes the batches from the average costs with detail::tune_batches(). The critical path of a batch is its
+/// longest system, so long systems are placed first and share batches. Conflicting systems keep the order of the
+/// initial placement, tuning changes which systems run concurrently but not what a system observes, so deterministic
+/// schedules stay deterministic.
 class stage_executor {
 public:
     using builder = stage; ///< Type alias for the stage builder.
 
     /// @brief Constructs a new stage executor.
     ///
+    /// Main thread systems are placed into the first batch they do not conflict with, they run once per stage run on
+    /// the main thread while worker threads run the rest of the batch.
+    ///
     /// @param name Name of the stage.
     /// @param executor_set Set of system executors.
     /// @param main_thread_executors Main thread system executors.
     explicit stage_executor(std::string_view name,
         std::vector<vector_of_executors_t> executor_set,
         vector_of_executors_t main_thread_executors) :
-        _executor_set(std::move(executor_set)), _main_thread_executors(std::move(main_thread_executors)), _name(name) {
+        _name(name) {
+        std::vector<access_pattern_t> batch_access;
+        for (auto& executors : executor_set) {
+            auto& batch = _batches.emplace_back();
+            auto& access_pattern = batch_access.emplace_back();
+            for (auto& executor : executors) {
+                access_pattern &= add_executor(std::move(executor), false);
+                batch.push_back(_executors.size() - 1);
+            }
+        }
+
+        for (auto& executor : main_thread_executors) {
+            auto system_access_pattern = executor->access_pattern();
+            auto it = std::ranges::find_if(
+                batch_access, [&](const auto& access_pattern) { return access_pattern.allows(system_access_pattern); });
+            auto batch = static_cast<std::size_t>(std::distance(batch_access.begin(), it));
+            if (it == batch_access.end()) {
+                _batches.emplace_back();
+                batch_access.emplace_back();
+            }
+            batch_access[batch] &= add_executor(std::move(executor), true);
+            _batches[batch].push_back(_executors.size() - 1);
+        }
     }
 
     /// @brief Runs all systems in the stage.
     void run() {
-        for (auto& executors : _executor_set) {
-            execute_batch(executors);
+        if (_window == 0) {
+            for (const auto& batch : _batches) {
+                sync(batch);
+                execute_batch(batch);
+            }
+            return;
+        }
+
+        auto start = clock_type::now();
+        for (const auto& batch : _batches) {
+            sync(batch);
+            execute_batch(batch);
         }
+        _stage_time += clock_type::now() - start;
+
+        if (++_runs == _window) {
+            retune();
+        }
+    }
+
+    /// @brief Enables auto tuning of the batches.
+    ///
+    /// @param window Number of runs costs are averaged over before batches are recomputed, 0 disables tuning.
+    void auto_tune(std::size_t window) {
+        _window = window;
+        _runs = 0;
+        _stage_time = {};
+        _costs.assign(_executors.size(), {});
+    }
+
+    /// @brief Enables automatic sync points.
+    ///
+    /// Before every batch the executor checks which components pending commands affect. When a system of the batch
+    /// accesses any of them the commands are flushed first, so the system sees the entities and components created by
+    /// systems that ran before it. Batches not touching the affected components run without flushing.
+    ///
+    /// @param registry Registry to flush commands to or nullptr to disable sync points.
+    /// @param order Order in which recorded commands are flushed.
+    void auto_sync(registry* registry, flush_order order = flush_order::registration) noexcept {
+        _sync_registry = registry;
+        _flush_order = order;
+    }
+
+    /// @brief Returns the number of sync points inserted so far.
+    ///
+    /// @return Number of flushes done before a batch.
+    [[nodiscard]] auto sync_points() const noexcept -> std::uint64_t {
+        return _sync_points;
+    }
+
+    /// @brief Returns the report of the last retune.
+    ///
+    /// @return Stage report.
+    [[nodiscard]] auto report() const noexcept -> const stage_report& {
+        return _report;
+    }
+
+    /// @brief Returns the number of batches systems are currently split into.
+    ///
+    /// @return Number of batches.
+    [[nodiscard]] auto batches() const noexcept -> std::size_t {
+        return _batches.size();
     }
 
 private:
+    using clock_type = std::chrono::steady_clock;
+    using batch_t = std::vector<std::size_t>;
+
+    /// @brief Recomputed batches replace the current ones when they are predicted faster by at least 1 / divisor
+    static constexpr std::int64_t min_gain_divisor = 10;
+
+    /// @brief Flushes pending commands when a system of the batch accesses components they affect.
+    ///
+    /// @param batch Indices of the systems in the batch about to run.
+    void sync(const batch_t& batch) {
+        if (_sync_registry == nullptr) {
+            return;
+        }
+        auto pending = command_buffer::pending();
+        if (pending.empty()
+            || std::ranges::none_of(batch, [&](auto index) { return pending.conflicts(_access[index]); })) {
+            return;
+        }
+        command_buffer::flush(*_sync_registry, _flush_order);
+        _sync_points++;
+    }
+
+    /// @brief Adds an executor to the list of systems.
+    ///
+    /// @param executor System executor.
+    /// @param main_thread Whether the system has to run on the main thread.
+    /// @return Access pattern of the system.
+    auto add_executor(std::unique_ptr<system_executor_interface> executor, bool main_thread)
+        -> const access_pattern_t& {
+        _executors.emplace_back(std::move(executor));
+        _main_thread.push_back(main_thread);
+        return _access.emplace_back(_executors.back()->access_pattern());
+    }
+
     /// @brief Executes a batch of systems.
     ///
-    /// @tparam WorkBatch Type of the work batch.
-    /// @param work_batch The batch of work to be executed.
-    template<typename WorkBatch>
-    void execute_batch(WorkBatch&& work_batch) {
+    /// Main thread systems of the batch are queued for the main thread, which runs them while it waits for the batch.
+    ///
+    /// @param batch Indices of the systems in the batch.
+    void execute_batch(const batch_t& batch) {
         task_t* parent{};
         thread_pool& _thread_pool = thread_pool::get();
 
-        for (auto& work_item : work_batch) {
-            auto task = _thread_pool.submit([&work_item]() { work_item->run(); }, parent);
+        // systems of the batch share the workers, main thread systems run one after another so they count as one,
+        // parallel loops inside the systems split their work for their share only
+        auto main_thread =
+            static_cast<std::size_t>(std::ranges::count_if(batch, [&](auto i) { return _main_thread[i]; }));
+        auto concurrent = batch.size() - main_thread + (main_thread == 0 ? 0 : 1);
+        auto parallelism = std::max<std::size_t>(_thread_pool.num_workers() / std::max<std::size_t>(concurrent, 1), 1);
+
+        for (auto index : batch) {
+            auto func = [this, index, parallelism]() {
+                parallelism_hint hint{ parallelism };
+                run_system(index);
+            };
+            auto task =
+                _main_thread[index] ? _thread_pool.submit_to_main(func, parent) : _thread_pool.submit(func, parent);
             if (!parent) {
                 parent = task;
             }
         }
 
-        // in the meantime execute main thread systems
-        for (auto& executor : _main_thread_executors) {
-            executor->run();
-        }
-
         if (parent) {
             _thread_pool.wait(parent);
         }
     }
 
+    /// @brief Runs a single system, measuring it when tuning is enabled. Every slot of _costs is written by the task
+    /// running its system only and read after the batch is waited for.
+    ///
+    /// @param index System index.
+    void run_system(std::size_t index) {
+        if (_window == 0) {
+            _executors[index]->run();
+            return;
+        }
+        auto start = clock_type::now();
+        _executors[index]->run();
+        _costs[index] += clock_type::now() - start;
+    }
+
+    /// @brief Predicts the makespan of batches, a batch takes at least as long as its longest system, as its main
+    /// thread systems one after another and as its total cost spread over all workers.
+    ///
+    /// @param batches Batches.
+    /// @param costs Average cost per system.
+    /// @param main_thread_systems Whether a system runs on the main thread.
+    /// @return Predicted makespan.
+    static auto predict(const std::vector<batch_t>& batches,
+        const std::vector<std::chrono::nanoseconds>& costs,
+        const std::vector<bool>& main_thread_systems) -> std::chrono::nanoseconds {
+        auto workers = static_cast<std::int64_t>(thread_pool::get().num_workers());
+        std::chrono::nanoseconds makespan{};
+        for (const auto& batch : batches) {
+            std::chrono::nanoseconds longest{};
+            std::chrono::nanoseconds total{};
+            std::chrono::nanoseconds main_thread{};
+            for (auto index : batch) {
+                longest = std::max(longest, costs[index]);
+                total += costs[index];
+                if (main_thread_systems[index]) {
+                    main_thread += costs[index];
+                }
+            }
+            makespan += std::max({ longest, main_thread, total / workers });
+        }
+        return makespan;
+    }
+
+    /// @brief Recomputes batches from the costs measured over the last window.
+    void retune() {
+        std::vector<std::chrono::nanoseconds> costs(_executors.size());
+        auto window = static_cast<std::int64_t>(_window);
+        for (std::size_t index = 0; index < costs.size(); index++) {
+            costs[index] = _costs[index] / window;
+        }
+
+        auto batches = detail::tune_batches(_batches, _access, costs);
+
+        _report.name = _name;
+        _report.predicted = predict(_batches, costs, _main_thread);
+        _report.actual = _stage_time / window;
+        _report.tuned = predict(batches, costs, _main_thread);
+        _report.retunes++;
+        // keep the current batches unless the gain is above measurement noise, so batches do not flip every window
+        if (_report.tuned < _report.predicted - _report.predicted / min_gain_divisor) {
+            _batches = std::move(batches);
+        } else {
+            _report.tuned = _report.predicted;
+        }
+        _report.batches = _batches.size();
+
+        _runs = 0;
+        _stage_time = {};
+        std::ranges::fill(_costs, std::chrono::nanoseconds{});
+
+        if (auto* instance = profiler::get()) {
+            instance->report_stage(_report);
+        }
+    }
+
 private:
-    std::vector<vector_of_executors_t> _executor_set;
-    vector_of_executors_t _main_thread_executors;
+    vector_of_executors_t _executors;
+    std::vector<access_pattern_t> _access;
+    std::vector<bool> _main_thread;
+    std::vector<batch_t> _batches;
     std::string_view _name;
-};
 
+    registry* _sync_registry{};
+    flush_order _flush_order{ flush_order::registration };
+    std::uint64_t _sync_points{};
+
+    std::size_t _window{};
+    std::size_t _runs{};
+    std::vector<std::chrono::nanoseconds> _costs;
+    std::chrono::nanoseconds _stage_time{};
+    stage_report _report{};
+};
 
 } // namespace co_ecs
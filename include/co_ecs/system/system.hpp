@@ -7,6 +7,8 @@
 
 #include <co_ecs/system/access.hpp>
 
+#include <atomic>
+
 namespace co_ecs {
 
 /// @brief System executor interface, a system is a type that implements run() method
@@ -259,20 +261,23 @@ public:
 
 /// @brief System command writer state
 ///
+/// Every state gets an order key in the order systems are created, so a deterministic flush plays commands in the
+/// schedule order no matter which worker executed the system.
 class system_command_writer_state {
 public:
     /// @brief Constructor
     ///
     /// @param registry Registry reference
     /// @param user_context User provided context to fetch data from and provide to the system
-    explicit system_command_writer_state(registry& registry, void* user_context) noexcept : _registry(registry) {
+    explicit system_command_writer_state(registry& registry, void* user_context) noexcept :
+        _registry(registry), _order(_next_order.fetch_add(1, std::memory_order::relaxed)) {
     }
 
     /// @brief Returns the actual state inside to pass to the system
     ///
     /// @return Command buffer
     [[nodiscard]] command_writer get() noexcept {
-        return command_writer(_registry);
+        return command_writer(_registry, _order);
     }
 
     /// @brief Get the access pattern of the entity.
@@ -283,7 +288,10 @@ public:
     }
 
 private:
+    static inline std::atomic<std::uint64_t> _next_order{ 1 };
+
     registry& _registry;
+    std::uint64_t _order;
 };
 
 /// @brief Specialization for command_buffer
@@ -3,52 +3,373 @@
 #include <co_ecs/detail/allocator/temp_allocator.hpp>
 #include <co_ecs/thread_pool/thread_pool.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <vector>
+
 namespace co_ecs {
 
+/// @brief Partitioner that splits work into as many batches as there are workers.
+///
+/// The resulting batches depend on the number of workers in the thread pool.
+struct auto_partitioner {
+    /// @brief Get the number of elements in a single batch
+    /// @param work_size Number of elements to process
+    /// @param num_workers Number of workers in the thread pool
+    /// @return Batch size
+    [[nodiscard]] constexpr auto grain_size(std::size_t work_size, std::size_t num_workers) const noexcept
+        -> std::size_t {
+        if (work_size < num_workers) {
+            // small range is processed in a single batch
+            return work_size;
+        }
+        return (work_size + num_workers - 1) / num_workers;
+    }
+};
+
+/// @brief Partitioner that splits work into batches of a fixed size.
+///
+/// The resulting batches do not depend on the number of workers, which makes the partition deterministic.
+struct fixed_partitioner {
+    /// @brief Number of elements in a single batch
+    std::size_t grain{ 1 };
+
+    /// @brief Get the number of elements in a single batch
+    /// @param work_size Number of elements to process
+    /// @param num_workers Number of workers in the thread pool
+    /// @return Batch size
+    [[nodiscard]] constexpr auto grain_size([[maybe_unused]] std::size_t work_size,
+        [[maybe_unused]] std::size_t num_workers) const noexcept -> std::size_t {
+        return std::max<std::size_t>(grain, 1);
+    }
+};
+
+/// @brief Partitioner concept, a partitioner decides how many elements a single batch of work holds
+///
+/// @tparam P Partitioner type
+template<typename P>
+concept partitioner = requires(const P& p, std::size_t size) {
+    { p.grain_size(size, size) } -> std::convertible_to<std::size_t>;
+};
+
+namespace detail {
+struct affinity_access;
+} // namespace detail
+
+/// @brief Partitioner that remembers which worker processed each batch and offers the batch to the same worker on the
+/// next run.
+///
+/// Keep the partitioner alive across frames and pass it to every run over the same data, so the chunks a worker
+/// processed last frame are likely still in its cache. Every worker first processes the batches it ran last time and
+/// then takes batches of other workers that have not started yet, so stealing still balances the load. Batch
+/// boundaries only depend on the number of elements, the history is reset when it changes.
+///
+/// @code
+/// co_ecs::affinity_partitioner affinity;
+///
+/// while (running) {
+///     view.par_each([](position& p, const velocity& v) { p.value += v.value; }, affinity);
+/// }
+/// @endcode
+///
+/// @note A partitioner must not be used by two parallel loops at the same time.
+class affinity_partitioner {
+public:
+    /// @brief Number of batches per worker, more batches give stealing a finer granularity
+    static constexpr std::size_t batches_per_worker = 4;
+
+    /// @brief Get the number of elements in a single batch
+    /// @param work_size Number of elements to process
+    /// @param num_workers Number of workers in the thread pool
+    /// @return Batch size
+    [[nodiscard]] constexpr auto grain_size(std::size_t work_size, std::size_t num_workers) const noexcept
+        -> std::size_t {
+        auto num_batches = num_workers * batches_per_worker;
+        return std::max<std::size_t>((work_size + num_batches - 1) / num_batches, 1);
+    }
+
+    /// @brief Get the number of batches executed by the worker that executed them on the previous run
+    /// @return Number of batches
+    [[nodiscard]] auto hits() const noexcept -> std::uint64_t {
+        return _hits.load(std::memory_order::relaxed);
+    }
+
+    /// @brief Get the number of batches executed by a different worker than on the previous run
+    /// @return Number of batches
+    [[nodiscard]] auto misses() const noexcept -> std::uint64_t {
+        return _misses.load(std::memory_order::relaxed);
+    }
+
+private:
+    friend struct detail::affinity_access;
+
+    // Distributes batches into per worker lists based on the workers that executed them last time, batches without
+    // history are distributed round robin
+    void prepare(std::size_t num_batches, std::size_t num_workers) {
+        if (_owners.size() != num_batches) {
+            _owners.resize(num_batches);
+            for (std::size_t i = 0; i < num_batches; i++) {
+                _owners[i] = i % num_workers;
+            }
+        }
+        if (_lists.size() != num_workers) {
+            _lists.resize(num_workers);
+            _cursors = std::make_unique<std::atomic<std::size_t>[]>(num_workers);
+        }
+        for (std::size_t worker = 0; worker < num_workers; worker++) {
+            _lists[worker].clear();
+            _cursors[worker].store(0, std::memory_order::relaxed);
+        }
+        for (std::size_t i = 0; i < num_batches; i++) {
+            if (_owners[i] >= num_workers) {
+                _owners[i] = i % num_workers;
+            }
+            _lists[_owners[i]].push_back(i);
+        }
+    }
+
+    // Claims a batch from the list of the given worker, then from lists of other workers
+    auto claim(std::size_t worker) noexcept -> std::optional<std::size_t> {
+        for (std::size_t k = 0; k < _lists.size(); k++) {
+            auto list = (worker + k) % _lists.size();
+            auto index = _cursors[list].fetch_add(1, std::memory_order::relaxed);
+            if (index < _lists[list].size()) {
+                return _lists[list][index];
+            }
+        }
+        return std::nullopt;
+    }
+
+    void record(std::size_t batch, std::size_t worker) noexcept {
+        if (std::exchange(_owners[batch], worker) == worker) {
+            _hits.fetch_add(1, std::memory_order::relaxed);
+        } else {
+            _misses.fetch_add(1, std::memory_order::relaxed);
+        }
+    }
+
+    std::vector<std::size_t> _owners;
+    std::vector<std::vector<std::size_t>> _lists;
+    std::unique_ptr<std::atomic<std::size_t>[]> _cursors;
+    std::atomic<std::uint64_t> _hits{};
+    std::atomic<std::uint64_t> _misses{};
+};
+
+namespace detail {
+
+/// @brief Gives parallel algorithms access to the batch history of an affinity partitioner
+struct affinity_access {
+    static void prepare(affinity_partitioner& affinity, std::size_t num_batches, std::size_t num_workers) {
+        affinity.prepare(num_batches, num_workers);
+    }
+
+    static auto claim(affinity_partitioner& affinity, std::size_t worker) noexcept -> std::optional<std::size_t> {
+        return affinity.claim(worker);
+    }
+
+    static void record(affinity_partitioner& affinity, std::size_t batch, std::size_t worker) noexcept {
+        affinity.record(batch, worker);
+    }
+};
+
+/// @brief Split range into batches of grain_size elements and run batch_func over them in parallel.
+///
+/// Batches are handed out one at a time to as many tasks as there are workers available to the caller, see
+/// thread_pool::available_parallelism(), so a loop started while other workers are busy does not flood their queues
+/// with tasks nobody is free to run. Once the token is cancelled no new batches are
+/// handed out. The batches are children of the task calling this function, if any, so cancelling that task cancels
+/// the batches as well.
+///
+/// With an affinity partitioner every worker first runs the batches it ran last time, then batches of other workers.
+///
+/// @tparam R Range type
+/// @param range Range to split
+/// @param grain_size Number of elements in a single batch
+/// @param token Cancellation token
+/// @param batch_func Function invoked with a subrange of elements and the index of the batch
+/// @param affinity Affinity partitioner keeping the batch history or nullptr
+template<typename R>
+void parallel_batches(R&& range,
+    std::size_t grain_size,
+    cancellation_token token,
+    auto&& batch_func,
+    affinity_partitioner* affinity = nullptr) {
+    auto& thread_pool = thread_pool::get();
+    auto work_size = static_cast<std::size_t>(std::ranges::distance(range));
+    grain_size = std::max<std::size_t>(grain_size, 1);
+    auto num_batches = (work_size + grain_size - 1) / grain_size;
+
+    if (num_batches == 0) {
+        return;
+    }
+
+    // prepare batch boundaries
+    using iterator_t = decltype(range.begin());
+    std::vector<iterator_t, detail::temp_allocator<iterator_t>> bounds;
+    {
+        bounds.reserve(num_batches + 1);
+        auto b = range.begin();
+        bounds.emplace_back(b);
+        auto step = static_cast<std::ranges::range_difference_t<R>>(grain_size);
+        for (std::size_t i = 0; i < num_batches; i++) {
+            b = (i < num_batches - 1) ? std::ranges::next(b, step) : range.end();
+            bounds.emplace_back(b);
+        }
+    }
+
+    auto num_tasks = std::min(num_batches, thread_pool.available_parallelism());
+
+    if (affinity) {
+        affinity_access::prepare(*affinity, num_batches, thread_pool.num_workers());
+    }
+
+    auto run_batch = [&](std::size_t i) {
+        batch_func(std::ranges::subrange(bounds[i], bounds[i + 1]), i);
+        if (affinity) {
+            affinity_access::record(*affinity, i, thread_pool::current_worker().id());
+        }
+    };
+
+    if (num_tasks == 1) {
+        // fast path for a single worker or a single batch, still stops once the calling task is cancelled
+        auto* parent = thread_pool::current_task();
+        auto cancelled = [&]() { return token.stop_requested() || (parent && parent->is_cancelled()); };
+        for (std::size_t i = 0; i < num_batches && !cancelled(); i++) {
+            run_batch(i);
+        }
+        return;
+    }
+
+    // the root is released only after every task is attached to it, so it cannot complete early
+    task_t* root = task_pool::allocate([]() {}, thread_pool::current_task(), std::move(token));
+    std::atomic<std::size_t> next_batch{};
+
+    auto next = [&]() -> std::optional<std::size_t> {
+        if (affinity) {
+            return affinity_access::claim(*affinity, thread_pool::current_worker().id());
+        }
+        auto i = next_batch.fetch_add(1, std::memory_order::relaxed);
+        return i < num_batches ? std::optional{ i } : std::nullopt;
+    };
+
+    auto run_batches = [&]() {
+        while (!root->is_cancelled()) {
+            auto i = next();
+            if (!i) {
+                break;
+            }
+            run_batch(*i);
+        }
+    };
+
+    for (std::size_t i = 0; i < num_tasks; i++) {
+        thread_pool.submit(run_batches, root);
+    }
+    root->execute();
+    thread_pool.wait(root);
+}
+
+} // namespace detail
+
 /// @brief Parallelize func over elements in range
+///
+/// Batches that have not started yet are skipped once the token is cancelled. The batches are children of the task
+/// calling parallel_for, if any, so cancelling that task cancels the batches as well. The partitioner splits the range
+/// for the number of workers the caller is expected to use, see parallelism_hint.
+///
 /// @tparam R Range type
 /// @param range Range to apply func to
 /// @param func Function
+/// @param partitioner Partitioner deciding the size of batches
+/// @param token Cancellation token
+template<typename R, partitioner P>
+void parallel_for(R&& range, auto&& func, const P& partitioner, cancellation_token token = {}) {
+    auto work_size = static_cast<std::size_t>(std::ranges::distance(range));
+    auto grain_size = partitioner.grain_size(work_size, thread_pool::get().parallelism());
+
+    detail::parallel_batches(
+        range, grain_size, std::move(token), [&func](auto batch, std::size_t) { std::ranges::for_each(batch, func); });
+}
+
+/// @brief Parallelize func over elements in range, offering every batch to the worker that processed it on the
+/// previous run with the same partitioner
+///
+/// @tparam R Range type
+/// @param range Range to apply func to
+/// @param func Function
+/// @param partitioner Affinity partitioner, keeps the batch history between runs
+/// @param token Cancellation token
 template<typename R>
-void parallel_for(R&& range, auto&& func) {
-    auto& thread_pool = thread_pool::get();
-    auto num_workers = thread_pool.num_workers();
-    auto work_size = std::ranges::distance(range);
-    auto batch_size = work_size / num_workers;
-
-    if (batch_size < 1) {
-        // fast path for small range
-        std::ranges::for_each(range, func);
-    } else {
-        // alias a subrange type that is our batch of work
-        using batch_t = decltype(std::ranges::subrange(range.begin(), range.end()));
-
-        std::vector<batch_t, detail::temp_allocator<batch_t>> batches;
-
-        // prepare batches
-        {
-            batches.reserve(num_workers);
-            auto b = range.begin();
-            auto e = b;
-            for (auto i = 0; i < num_workers; i++) {
-                auto e = (i < num_workers - 1) ? std::next(b, batch_size) : range.end();
-                batches.emplace_back(std::ranges::subrange(b, e));
-                b = e;
-            }
+void parallel_for(R&& range, auto&& func, affinity_partitioner& partitioner, cancellation_token token = {}) {
+    auto work_size = static_cast<std::size_t>(std::ranges::distance(range));
+    auto grain_size = partitioner.grain_size(work_size, thread_pool::get().num_workers());
+
+    detail::parallel_batches(
+        range,
+        grain_size,
+        std::move(token),
+        [&func](auto batch, std::size_t) { std::ranges::for_each(batch, func); },
+        &partitioner);
+}
+
+/// @brief Parallelize func over elements in range, splitting it into a batch per worker
+///
+/// @tparam R Range type
+/// @param range Range to apply func to
+/// @param func Function
+/// @param token Cancellation token
+template<typename R>
+void parallel_for(R&& range, auto&& func, cancellation_token token = {}) {
+    parallel_for(std::forward<R>(range), std::forward<decltype(func)>(func), auto_partitioner{}, std::move(token));
+}
+
+/// @brief Reduce elements in range in parallel.
+///
+/// Every batch folds its elements from left to right starting with init, then batch results are combined in a fixed
+/// binary tree order. Together with a fixed partitioner the result does not depend on the number of workers nor on the
+/// order batches were executed in, which matters for non-associative operations like floating point addition.
+///
+/// @code
+/// auto sum = co_ecs::parallel_reduce(
+///     values, 0.0, [](double v) { return v; }, std::plus{}, co_ecs::fixed_partitioner{ 1024 });
+/// @endcode
+///
+/// @tparam R Range type
+/// @tparam T Result type
+/// @param range Range to reduce
+/// @param init Identity value of the combine operation
+/// @param transform Function converting an element to T
+/// @param combine Function combining two T values
+/// @param partitioner Partitioner deciding the size of batches
+/// @return Reduced value or init when the range is empty
+template<typename R, typename T>
+auto parallel_reduce(R&& range, T init, auto&& transform, auto&& combine, fixed_partitioner partitioner) -> T {
+    auto work_size = static_cast<std::size_t>(std::ranges::distance(range));
+    auto grain_size = partitioner.grain_size(work_size, thread_pool::get().num_workers());
+    auto num_batches = (work_size + grain_size - 1) / grain_size;
+
+    std::vector<T> partials(num_batches, init);
+
+    detail::parallel_batches(range, grain_size, {}, [&](auto batch, std::size_t index) {
+        T acc = init;
+        for (auto&& elem : batch) {
+            acc = combine(std::move(acc), transform(elem));
         }
+        partials[index] = std::move(acc);
+    });
 
-        // submit batches
-        {
-            task_t* parent = nullptr;
-            for (auto& batch : batches) {
-                auto* task = thread_pool.submit([&batch, &func]() { std::ranges::for_each(batch, func); }, parent);
-                if (!parent) {
-                    parent = task;
-                }
-            }
-            thread_pool.wait(parent);
+    // combine batch results pairwise in a fixed tree order
+    for (std::size_t stride = 1; stride < partials.size(); stride *= 2) {
+        for (std::size_t i = 0; i + stride < partials.size(); i += 2 * stride) {
+            partials[i] = combine(std::move(partials[i]), std::move(partials[i + stride]));
         }
     }
+
+    return partials.empty() ? init : std::move(partials.front());
 }
 
 } // namespace co_ecs
@@ -3,9 +3,16 @@
 #include <array>
 #include <atomic>
 #include <functional>
+#include <stop_token>
 
 namespace co_ecs {
 
+/// @brief Token a task polls to find out whether its work is still wanted.
+using cancellation_token = std::stop_token;
+
+/// @brief Owning side of a cancellation token, requests cancellation of every task observing its tokens.
+using cancellation_source = std::stop_source;
+
 /// @brief Represents a task that can be executed, monitored for completion, and linked to a parent task.
 class task_t {
 public:
@@ -15,23 +22,34 @@ public:
     /// @brief Constructs a task from a callable function and optionally links it to a parent task.
     /// @param func A callable object to be executed as the task.
     /// @param parent Optional pointer to a parent task, defaults to nullptr if no parent is specified.
-    task_t(auto&& func, task_t* parent = nullptr) : _func(std::forward<decltype(func)>(func)), _parent(parent) {
+    /// @param token Optional cancellation token, the task is also cancelled when any of its parents is cancelled.
+    task_t(auto&& func, task_t* parent = nullptr, cancellation_token token = {}) :
+        _func(std::forward<decltype(func)>(func)), _parent(parent), _token(std::move(token)) {
         _unfinishedTasks.store(1, std::memory_order::relaxed);
         if (_parent) {
             _parent->_unfinishedTasks.fetch_add(1, std::memory_order::relaxed);
         }
     }
 
-    /// @brief Executes the task's function and marks it as completed.
+    /// @brief Executes the task's function and marks it as completed. The function is skipped when the task has
+    /// been cancelled before it started.
     void execute() {
-        _func();
+        if (!is_cancelled()) {
+            _func();
+        }
         finish();
     }
 
+    /// @brief Checks if the task or any of its parents has been cancelled.
+    /// @return True if the task is cancelled, otherwise false.
+    bool is_cancelled() const noexcept {
+        return _token.stop_requested() || (_parent && _parent->is_cancelled());
+    }
+
     /// @brief Checks if the task has been completed.
     /// @return True if the task is completed, otherwise false.
     bool is_completed() const noexcept {
-        return _unfinishedTasks.load(std::memory_order::relaxed) == 0;
+        return _unfinishedTasks.load(std::memory_order::acquire) == 0;
     }
 
     /// @brief Retrieves the parent task if it exists.
@@ -42,15 +60,15 @@ public:
 
 private:
     void finish() {
-        _unfinishedTasks.fetch_sub(1, std::memory_order::relaxed);
-
-        if (is_completed() && _parent) {
+        // only the last finishing child may notify the parent
+        if (_unfinishedTasks.fetch_sub(1, std::memory_order::acq_rel) == 1 && _parent) {
             _parent->finish();
         }
     }
 
     std::function<void()> _func{};          ///< The function that the task executes.
     task_t* _parent{};                      ///< Optional pointer to the parent task.
+    cancellation_token _token{};            ///< Cancellation token of this task.
     std::atomic<uint16_t> _unfinishedTasks; ///< Atomic counter for tracking unfinished tasks.
 };
 
@@ -64,11 +82,12 @@ public:
     /// @brief Allocates a task with the specified function and parent, placing it in a circular buffer.
     /// @param func A callable object to be executed by the task.
     /// @param parent Optional pointer to a parent task.
+    /// @param token Optional cancellation token.
     /// @return Pointer to the newly allocated task.
-    static task_t* allocate(auto&& func, task_t* parent = nullptr) {
+    static task_t* allocate(auto&& func, task_t* parent = nullptr, cancellation_token token = {}) {
         auto& task = _tasks_array[_task_counter++ & (max_tasks - 1)];
         task.~task_t();
-        new (&task) task_t(std::forward<decltype(func)>(func), parent);
+        new (&task) task_t(std::forward<decltype(func)>(func), parent, std::move(token));
         return &task;
     }
 
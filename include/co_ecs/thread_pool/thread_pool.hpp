@@ -1,19 +1,58 @@
 #pragma once
 
+#include <co_ecs/detail/numa.hpp>
 #include <co_ecs/detail/work_stealing_queue.hpp>
 #include <co_ecs/thread_pool/task.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <mutex>
 #include <random>
 #include <semaphore>
 #include <thread>
 
 namespace co_ecs {
 
+/// @brief Number of workers the code running on the current thread is expected to share the pool with.
+///
+/// A hint installs itself as the current one for its lifetime. The scheduler installs a hint for every system so that
+/// systems running next to each other split the workers between them instead of each one fanning out parallel loops
+/// over the whole pool, see thread_pool::parallelism().
+class parallelism_hint {
+public:
+    /// @brief Install a hint on the current thread
+    ///
+    /// @param workers Number of workers the current thread is expected to use, including itself
+    explicit parallelism_hint(std::size_t workers) noexcept : _outer(std::exchange(current_hint, workers)) {
+    }
+
+    /// @brief Restore the previously installed hint
+    ~parallelism_hint() {
+        current_hint = _outer;
+    }
+
+    parallelism_hint(const parallelism_hint&) = delete;
+    parallelism_hint& operator=(const parallelism_hint&) = delete;
+
+    /// @brief Get the hint installed on the current thread
+    ///
+    /// @return Number of workers or 0 when no hint is installed
+    [[nodiscard]] static auto current() noexcept -> std::size_t {
+        return current_hint;
+    }
+
+private:
+    static inline thread_local std::size_t current_hint{};
+
+    std::size_t _outer;
+};
+
 /// @brief Generic thread pool implementation.
 ///
 /// Creates N worker threads. Each thread has its own local task queue
 /// that it can push/pop task items to/from. Once there's no tasks in
-/// local queue a worker thread tries to steal a task from a random worker.
+/// local queue a worker thread tries to steal a task from a random worker. On machines with several NUMA nodes workers
+/// on the same node are preferred when stealing. Tasks submitted with submit_to_main() are run by the main worker only.
 class thread_pool {
 public:
     using thread_t = std::thread;
@@ -54,6 +93,12 @@ public:
             return _id;
         }
 
+        /// @brief Return NUMA node of the CPU the worker ran on last time it checked, 0 on single node machines
+        /// @return NUMA node
+        [[nodiscard]] std::size_t node() const noexcept {
+            return _node.load(std::memory_order::relaxed);
+        }
+
         /// @brief Get current thread worker
         /// @return Returns a worker dedicated to the thread this method is invoked from
         static worker& current() noexcept {
@@ -63,8 +108,9 @@ public:
         /// @brief Submit a task into local workers queue
         /// @param func Function
         /// @param parent Parent task pointer
-        task_t* submit(auto&& func, task_t* parent = nullptr) {
-            task_t* task = task_pool::allocate(std::forward<decltype(func)>(func), parent);
+        /// @param token Cancellation token
+        task_t* submit(auto&& func, task_t* parent = nullptr, cancellation_token token = {}) {
+            task_t* task = task_pool::allocate(std::forward<decltype(func)>(func), parent, std::move(token));
             submit(task);
             return task;
         }
@@ -76,7 +122,8 @@ public:
             _pool.wake_worker();
         }
 
-        /// @brief Wait for task completion
+        /// @brief Wait for task completion. Tasks of a cancelled subtree that have not started yet are discarded
+        /// without running, so waiting on a cancelled task only lasts until its in-flight tasks finish.
         /// @param task Task
         void wait(task_t* task) {
             while (!task->is_completed()) {
@@ -92,6 +139,12 @@ public:
             }
         }
 
+        /// @brief Get the task this worker is currently executing
+        /// @return Task pointer or nullptr when the worker is not executing any task
+        [[nodiscard]] task_t* current_task() const noexcept {
+            return _current_task;
+        }
+
 #ifdef CO_ECS_WORKER_STATS
         /// @brief Get worker stats
         /// @return Stats
@@ -107,6 +160,7 @@ public:
 
         void run() {
             current_worker = this;
+            update_node();
 
             while (true) {
                 task_t* task;
@@ -146,7 +200,14 @@ public:
         }
 
         [[nodiscard]] task_t* get_task() {
-            // First, attempt to retrieve a task from the worker's own local queue.
+            // Tasks bound to the main thread are only ever taken by the main worker.
+            if (worker* main_worker = &_pool.main_worker(); main_worker == this) {
+                if (auto* task = _pool.pop_main_task()) {
+                    return task;
+                }
+            }
+
+            // Attempt to retrieve a task from the worker's own local queue.
             if (auto maybe_task = get_queue().pop()) {
                 return *maybe_task;
             }
@@ -158,6 +219,13 @@ public:
                 }
             }
 
+            // Prefer a worker on the same NUMA node, its tasks are likely to touch memory local to this node.
+            if (worker* near_worker = _pool.random_worker_on_node(node()); near_worker && near_worker != this) {
+                if (auto maybe_task = steal(*near_worker)) {
+                    return *maybe_task;
+                }
+            }
+
             // If stealing from the main worker fails, attempt to steal from a random worker.
             // This method is optimal for smaller numbers of workers (e.g., 4-8).
             if (worker* random_worker = _pool.random_worker(); random_worker && random_worker != this) {
@@ -181,14 +249,20 @@ public:
         }
 
         void execute(task_t* task) {
+            // tasks may nest when a task waits on its children, restore the outer one afterwards
+            auto* outer_task = std::exchange(_current_task, task);
             task->execute();
+            _current_task = outer_task;
 #ifdef CO_ECS_WORKER_STATS
             _stats.inc_task();
 #endif
         }
 
         void idle() {
+            _pool._idle_workers.fetch_add(1, std::memory_order::relaxed);
             _pool.wait();
+            _pool._idle_workers.fetch_sub(1, std::memory_order::relaxed);
+            update_node();
 
 #ifdef CO_ECS_WORKER_STATS
             _stats.inc_idle();
@@ -200,11 +274,18 @@ public:
             return _queue;
         }
 
+        // threads are not pinned, so the node is refreshed whenever the worker runs out of work
+        void update_node() noexcept {
+            _node.store(detail::numa::topology::get().current_node(), std::memory_order::relaxed);
+        }
+
     private:
         detail::work_stealing_queue<task_t*> _queue;
         thread_pool& _pool;
 
         std::atomic<bool> _active{ true };
+        std::atomic<std::size_t> _node{};
+        task_t* _current_task{};
         thread_t _thread{};
         std::size_t _id;
 #ifdef CO_ECS_WORKER_STATS
@@ -213,19 +294,22 @@ public:
     };
 
     /// @brief Construct thread pool with num_workers workers
+    ///
+    /// A thread pool created while another one exists replaces it as the current instance until it is destroyed, so
+    /// pools have to be destroyed in reverse order of creation. Must be called from the main thread.
+    ///
     /// @param num_workers The number of workers to create
     thread_pool(std::size_t num_workers = std::thread::hardware_concurrency()) {
         assert(num_workers > 0 && "Number of workers should be > 0");
         _workers.reserve(num_workers);
 
-        if (_instance) {
-            throw std::logic_error("Thread pool already created");
-        }
-        _instance = this;
+        _previous_instance = std::exchange(_instance, this);
+        _previous_main_worker = worker::current_worker;
 
         // create main worker that will execute tasks in main thread
         _workers.emplace_back(std::make_unique<worker>(*this, 0));
         worker::current_worker = _workers[0].get();
+        _workers[0]->update_node();
 
         // create background workers
         for (auto i = 1; i < num_workers; i++) {
@@ -250,7 +334,9 @@ public:
             _workers[i]->join();
         }
 
-        _instance = nullptr;
+        assert((_instance == this) && "Thread pools must be destroyed in reverse order of creation");
+        _instance = _previous_instance;
+        worker::current_worker = _previous_main_worker;
     }
 
     thread_pool(const thread_pool&) = delete;
@@ -273,16 +359,71 @@ public:
     /// @brief Submit a task to a thread pool
     /// @param func Function
     /// @param parent Parent task pointer
-    task_t* submit(auto&& func, task_t* parent = nullptr) {
-        return current_worker().submit(std::forward<decltype(func)>(func), parent);
+    /// @param token Cancellation token
+    task_t* submit(auto&& func, task_t* parent = nullptr, cancellation_token token = {}) {
+        return current_worker().submit(std::forward<decltype(func)>(func), parent, std::move(token));
+    }
+
+    /// @brief Submit a task owned by the caller, for tasks outliving the task pool slots of the submitting thread
+    /// @param task Task, must stay alive until it completes
+    void submit(task_t* task) {
+        current_worker().submit(task);
+    }
+
+    /// @brief Submit a task that has to run on the main thread.
+    ///
+    /// The task is queued in a queue only the main worker takes tasks from. It runs once the main thread waits for a
+    /// task or calls run_main_tasks(), so a thread waiting for it relies on the main thread doing either.
+    ///
+    /// @param func Function
+    /// @param parent Parent task pointer
+    /// @param token Cancellation token
+    task_t* submit_to_main(auto&& func, task_t* parent = nullptr, cancellation_token token = {}) {
+        task_t* task = task_pool::allocate(std::forward<decltype(func)>(func), parent, std::move(token));
+        {
+            std::lock_guard lock(_main_queue_mutex);
+            _main_queue.push_back(task);
+            _main_queue_size.fetch_add(1, std::memory_order::release);
+        }
+        _worker_wait_semaphore.release();
+        return task;
+    }
+
+    /// @brief Run tasks queued for the main thread, must be called from the main thread
+    /// @return Number of tasks run
+    std::size_t run_main_tasks() {
+        assert((&current_worker() == &main_worker()) && "Main thread tasks must be run from the main thread");
+        std::size_t count{};
+        while (auto* task = pop_main_task()) {
+            main_worker().execute(task);
+            count++;
+        }
+        return count;
+    }
+
+    /// @brief Run a single pending task on the current worker, if there is one
+    /// @return True if a task was run
+    bool run_pending_task() {
+        auto& worker = current_worker();
+        if (auto* task = worker.get_task()) {
+            worker.execute(task);
+            return true;
+        }
+        return false;
     }
 
-    /// @brief Wait a task to complete
+    /// @brief Wait a task to complete, returns early for cancelled tasks as unstarted work is discarded
     /// @param task
     void wait(task_t* task) {
         current_worker().wait(task);
     }
 
+    /// @brief Get the task executed by the current worker
+    /// @return Task pointer or nullptr when called outside of a task
+    static task_t* current_task() noexcept {
+        return current_worker().current_task();
+    }
+
     /// @brief Get worker by ID
     /// @param id Worker ID
     /// @return Worker
@@ -297,6 +438,43 @@ public:
         return _workers.size();
     }
 
+    /// @brief Return the number of workers waiting for work
+    /// @return Number of idle workers, a snapshot that may be outdated by the time it is used
+    [[nodiscard]]
+    std::size_t idle_workers() const noexcept {
+        return _idle_workers.load(std::memory_order::relaxed);
+    }
+
+    /// @brief Return the number of tasks queued in all workers queues
+    /// @return Number of queued tasks, a snapshot that may be outdated by the time it is used
+    [[nodiscard]]
+    std::size_t queued_tasks() const noexcept {
+        std::size_t queued{};
+        for (const auto& worker : _workers) {
+            queued += worker->_queue.size();
+        }
+        return queued;
+    }
+
+    /// @brief Return the number of workers the current thread is expected to use, the installed parallelism hint or
+    /// all workers when there is none
+    /// @return Number of workers, at least 1
+    [[nodiscard]]
+    std::size_t parallelism() const noexcept {
+        auto hint = parallelism_hint::current();
+        return hint == 0 ? num_workers() : std::clamp<std::size_t>(hint, 1, num_workers());
+    }
+
+    /// @brief Return the number of workers that can help the current thread right now: the current thread itself and
+    /// the idle workers not needed for already queued tasks, limited by parallelism()
+    /// @return Number of workers, at least 1
+    [[nodiscard]]
+    std::size_t available_parallelism() const noexcept {
+        auto idle = idle_workers();
+        auto free = idle - std::min(idle, queued_tasks());
+        return std::min(parallelism(), free + 1);
+    }
+
     /// @brief Get current worker
     /// @return Worker
     static worker& current_worker() noexcept {
@@ -322,6 +500,38 @@ private:
         return _workers[random_index].get();
     }
 
+    worker* random_worker_on_node(std::size_t node) noexcept {
+        if (!detail::numa::topology::get().enabled() || num_workers() == 1) {
+            return nullptr;
+        }
+
+        std::uniform_int_distribution<std::size_t> dist{ 1, num_workers() - 1 };
+        std::default_random_engine random_engine{ std::random_device()() };
+
+        auto start = dist(random_engine);
+        for (std::size_t i = 0; i < num_workers() - 1; i++) {
+            auto* candidate = _workers[1 + (start - 1 + i) % (num_workers() - 1)].get();
+            if (candidate->node() == node) {
+                return candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    task_t* pop_main_task() {
+        if (_main_queue_size.load(std::memory_order::acquire) == 0) {
+            return nullptr;
+        }
+        std::lock_guard lock(_main_queue_mutex);
+        if (_main_queue.empty()) {
+            return nullptr;
+        }
+        auto* task = _main_queue.front();
+        _main_queue.pop_front();
+        _main_queue_size.fetch_sub(1, std::memory_order::relaxed);
+        return task;
+    }
+
     void wake_worker() {
         _worker_wait_semaphore.release();
     }
@@ -334,8 +544,14 @@ private:
 private:
     static inline thread_pool* _instance;
 
+    thread_pool* _previous_instance{};
+    worker* _previous_main_worker{};
     std::vector<std::unique_ptr<worker>> _workers;
     std::counting_semaphore<> _worker_wait_semaphore{ 0 };
+    std::atomic<std::size_t> _idle_workers{};
+    std::mutex _main_queue_mutex;
+    std::deque<task_t*> _main_queue;
+    std::atomic<std::size_t> _main_queue_size{};
 };
 
 } // namespace co_ecs
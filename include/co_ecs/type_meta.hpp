@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string_view>
+#include <type_traits>
 
 namespace co_ecs {
 
@@ -84,6 +85,8 @@ struct type_meta {
             &move_constructor<T>,
             &move_assignment<T>,
             &destructor<T>,
+            std::is_trivially_destructible_v<T>,
+            std::is_trivially_copyable_v<T>,
         };
         return &meta;
     }
@@ -95,6 +98,8 @@ struct type_meta {
     void (*move_construct)(void*, void*);
     void (*move_assign)(void*, void*);
     void (*destruct)(void*);
+    bool trivially_destructible;
+    bool trivially_copyable;
 };
 
 
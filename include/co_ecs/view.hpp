@@ -1,9 +1,12 @@
 #pragma once
 
+#include <co_ecs/access_profile.hpp>
 #include <co_ecs/detail/views.hpp>
 #include <co_ecs/registry.hpp>
 #include <co_ecs/thread_pool/parallel_for.hpp>
 
+#include <cstring>
+#include <span>
 #include <type_traits>
 
 namespace co_ecs {
@@ -129,22 +132,161 @@ public:
 
     /// @brief Runs a function on every entity that matches the Args requirement in parallel.
     /// @param func A callable to run on entity components.
-    void par_each(auto&& func)
+    /// @param token Cancellation token, chunks that were not handed out yet are skipped once it is cancelled.
+    void par_each(auto&& func, cancellation_token token = {})
         requires(!is_const)
     {
-        co_ecs::parallel_for(chunks(),
-            [&func](auto chunk) { std::ranges::for_each(chunk, [&](auto&& elem) { std::apply(func, elem); }); });
+        co_ecs::parallel_for(
+            chunks(),
+            parallel_chunk_func(func),
+            std::move(token));
     }
 
     /// @brief Runs a function on every entity that matches the Args requirement in parallel (const version).
     ///
     /// @param func A callable to run on entity components.
+    /// @param token Cancellation token, chunks that were not handed out yet are skipped once it is cancelled.
     /// @note This method is similar to the non-const par_each() but is available in const views.
-    void par_each(auto&& func) const
+    void par_each(auto&& func, cancellation_token token = {}) const
         requires(is_const)
     {
-        co_ecs::parallel_for(chunks(),
-            [&func](auto chunk) { std::ranges::for_each(chunk, [&](auto&& elem) { std::apply(func, elem); }); });
+        co_ecs::parallel_for(
+            chunks(),
+            parallel_chunk_func(func),
+            std::move(token));
+    }
+
+    /// @brief Runs a function on every entity that matches the Args requirement in parallel, chunks are split into
+    /// batches by the given partitioner.
+    ///
+    /// @code
+    /// co_ecs::affinity_partitioner affinity; // kept across frames
+    /// view.par_each([](position& p, const velocity& v) { p.value += v.value; }, affinity);
+    /// @endcode
+    ///
+    /// @tparam P Partitioner type
+    /// @param func A callable to run on entity components.
+    /// @param partition Partitioner deciding how chunks are split into batches.
+    /// @param token Cancellation token, chunks that were not handed out yet are skipped once it is cancelled.
+    template<partitioner P>
+    void par_each(auto&& func, P&& partition, cancellation_token token = {})
+        requires(!is_const)
+    {
+        co_ecs::parallel_for(
+            chunks(),
+            parallel_chunk_func(func),
+            partition,
+            std::move(token));
+    }
+
+    /// @brief Runs a function on every entity that matches the Args requirement in parallel, chunks are split into
+    /// batches by the given partitioner (const version).
+    ///
+    /// @tparam P Partitioner type
+    /// @param func A callable to run on entity components.
+    /// @param partition Partitioner deciding how chunks are split into batches.
+    /// @param token Cancellation token, chunks that were not handed out yet are skipped once it is cancelled.
+    template<partitioner P>
+    void par_each(auto&& func, P&& partition, cancellation_token token = {}) const
+        requires(is_const)
+    {
+        co_ecs::parallel_for(
+            chunks(),
+            parallel_chunk_func(func),
+            partition,
+            std::move(token));
+    }
+
+    /// @brief Reduces components of every entity that matches the Args requirement in parallel.
+    ///
+    /// Entities of a chunk are folded in order and chunk results are combined in a fixed tree order, so the result
+    /// does not depend on the number of workers.
+    ///
+    /// @code
+    /// auto total_mass = view.par_reduce(0.0f, [](const mass& m) { return m.value; }, std::plus{});
+    /// @endcode
+    ///
+    /// @tparam T Result type
+    /// @param init Identity value of the combine operation
+    /// @param transform A callable converting entity components to T
+    /// @param combine A callable combining two T values
+    /// @return Reduced value or init when there are no matching entities
+    template<typename T>
+    auto par_reduce(T init, auto&& transform, auto&& combine) -> T
+        requires(!is_const)
+    {
+        return par_reduce_impl(chunks(), std::move(init), transform, combine);
+    }
+
+    /// @brief Reduces components of every entity that matches the Args requirement in parallel (const version).
+    ///
+    /// @tparam T Result type
+    /// @param init Identity value of the combine operation
+    /// @param transform A callable converting entity components to T
+    /// @param combine A callable combining two T values
+    /// @return Reduced value or init when there are no matching entities
+    template<typename T>
+    auto par_reduce(T init, auto&& transform, auto&& combine) const -> T
+        requires(is_const)
+    {
+        return par_reduce_impl(chunks(), std::move(init), transform, combine);
+    }
+
+    /// @brief Returns the number of entities that match the Args requirement.
+    /// @return Number of entities.
+    [[nodiscard]] auto size() const -> std::size_t {
+        std::size_t size{};
+        for (auto chunk : chunks()) {
+            size += chunk.size();
+        }
+        return size;
+    }
+
+    /// @brief Copies components of every entity that matches the Args requirement into dense arrays in parallel.
+    ///
+    /// Output vectors are resized to the number of entities, chunk offsets are computed upfront and every chunk copies
+    /// its columns independently, using memcpy for trivially copyable components. Element i of every output belongs to
+    /// the same entity. Pair it with double_buffer to let consumers read the previous extraction while the next one
+    /// is written.
+    ///
+    /// @code
+    /// std::vector<co_ecs::entity> ids;
+    /// std::vector<transform> transforms;
+    /// co_ecs::view<const transform&>{ registry }.par_extract(ids, transforms);
+    /// @endcode
+    ///
+    /// @tparam Cs Component types to extract, every type must be an entity or a component in Args
+    /// @param out Output vectors, one per component type
+    /// @return Number of extracted entities
+    template<component... Cs>
+    auto par_extract(std::vector<Cs>&... out) const -> std::size_t {
+        static_assert((is_requested<Cs> && ...), "Extracted components must be requested by the view");
+
+        auto chunks_range = chunks();
+        using chunk_view_t = chunk_view<Args...>;
+
+        auto num_chunks = static_cast<std::size_t>(std::ranges::distance(chunks_range));
+        std::vector<chunk_view_t, detail::temp_allocator<chunk_view_t>> chunk_views;
+        std::vector<std::size_t, detail::temp_allocator<std::size_t>> offsets;
+        chunk_views.reserve(num_chunks);
+        offsets.reserve(num_chunks + 1);
+
+        // prefix sums over chunk sizes give every chunk its own output range
+        std::size_t size{};
+        for (auto chunk : chunks_range) {
+            chunk_views.emplace_back(chunk);
+            offsets.emplace_back(size);
+            size += chunk.size();
+        }
+        offsets.emplace_back(size);
+
+        (..., out.resize(size));
+
+        co_ecs::parallel_for(std::views::iota(std::size_t{}, num_chunks), [&](std::size_t i) {
+            (..., copy_column(chunk_views[i].template column<Cs>(), out.data() + offsets[i]));
+        });
+
+        return size;
     }
 
     /// @brief Gets the chunks range.
@@ -160,6 +302,10 @@ public:
     }
 
 private:
+    template<component C>
+    constexpr static bool is_requested =
+        std::is_same_v<C, entity> || (std::is_same_v<C, decay_component_t<Args>> || ...);
+
     template<component C>
     constexpr static bool match(auto& archetype) {
         if constexpr (std::is_same_v<C, entity>) {
@@ -169,7 +315,42 @@ private:
         }
     }
 
+    template<component C>
+    static void copy_column(std::span<const C> column, C* out) {
+        if constexpr (std::is_trivially_copyable_v<C>) {
+            if (!column.empty()) {
+                std::memcpy(out, column.data(), column.size_bytes());
+            }
+        } else {
+            std::ranges::copy(column, out);
+        }
+    }
+
+    // Wraps func into a function processing a chunk on a worker, chunk memory follows the NUMA node of its workers
+    static auto parallel_chunk_func(auto& func) {
+        return [&func](auto chunk) {
+            if (detail::numa::topology::get().enabled()) {
+                chunk.prefer_node(thread_pool::current_worker().node());
+            }
+            std::ranges::for_each(chunk, [&](auto&& elem) { std::apply(func, elem); });
+        };
+    }
+
+    template<typename T>
+    static auto par_reduce_impl(auto&& chunks, T init, auto& transform, auto& combine) -> T {
+        auto reduce_chunk = [&](auto chunk) {
+            T acc = init;
+            for (auto entry : chunk) {
+                acc = combine(std::move(acc), std::apply(transform, entry));
+            }
+            return acc;
+        };
+        return co_ecs::parallel_reduce(chunks, init, reduce_chunk, combine, fixed_partitioner{ 1 });
+    }
+
     constexpr static auto chunks(auto&& archetypes) -> decltype(auto) {
+        access_profile::record<decay_component_t<Args>...>();
+
         auto filter_archetypes = [](auto& archetype) -> bool {
             return (match<decay_component_t<Args>>(archetype) && ...);
         };
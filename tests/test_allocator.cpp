@@ -1,6 +1,7 @@
 #include <catch2/catch_all.hpp>
 
 #include <co_ecs/detail/allocator/linear_allocator.hpp>
+#include <co_ecs/detail/allocator/slab_pool.hpp>
 #include <co_ecs/detail/allocator/stack_allocator.hpp>
 
 using namespace co_ecs::detail;
@@ -52,4 +53,38 @@ TEST_CASE("Stack allocator") {
     REQUIRE(alloc.remaining() == remaining);
 
     alloc.deallocate(ptr);
-}
\ No newline at end of file
+}
+TEST_CASE("Slab pool") {
+    slab_pool pool;
+
+    auto* a = pool.allocate(100);
+    auto* b = pool.allocate(2000);
+    REQUIRE((std::size_t(a) % slab_pool::slab_alignment) == 0);
+    REQUIRE((std::size_t(b) % slab_pool::slab_alignment) == 0);
+    REQUIRE(pool.used_bytes() == 128 + 2048);
+
+    // freed slabs are reused for the same size class
+    pool.deallocate(a, 100);
+    REQUIRE(pool.cached_bytes() == 128);
+    REQUIRE(pool.allocate(128) == a);
+    REQUIRE(pool.cached_bytes() == 0);
+
+    pool.deallocate(a, 128);
+    pool.deallocate(b, 2000);
+    REQUIRE(pool.used_bytes() == 0);
+    REQUIRE(pool.cached_bytes() == 128 + 2048);
+
+    // fragmented pool releases cached slabs
+    std::vector<std::byte*> slabs;
+    for (int i = 0; i < 64; i++) {
+        slabs.push_back(pool.allocate(64 * 1024));
+    }
+    for (auto* slab : slabs) {
+        pool.deallocate(slab, 64 * 1024);
+    }
+    REQUIRE(pool.used_bytes() == 0);
+    REQUIRE(pool.cached_bytes() <= slab_pool::min_cached_bytes);
+
+    pool.compact();
+    REQUIRE(pool.cached_bytes() == 0);
+}
@@ -3,6 +3,12 @@
 
 #include "components.hpp"
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
 using namespace co_ecs;
 
 TEST_CASE("Command Buffer") {
@@ -70,4 +76,164 @@ TEST_CASE("Command Buffer") {
 
         REQUIRE_FALSE(registry.alive(recorded_entity));
     }
-}
\ No newline at end of file
+}
+
+struct label {
+    std::string text;
+};
+
+TEST_CASE("Command log replay") {
+    component_serializers::add<foo<0>>();
+    component_serializers::add<foo<1>>();
+    component_serializers::add<foo<2>>();
+    component_serializers::add<label>(
+        [](const label& value, std::vector<std::byte>& out) {
+            const auto* bytes = reinterpret_cast<const std::byte*>(value.text.data());
+            out.insert(out.end(), bytes, bytes + value.text.size());
+        },
+        [](std::span<const std::byte> bytes) {
+            return label{ std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size()) };
+        });
+
+    // both worlds start from the same state
+    co_ecs::registry recorded;
+    co_ecs::registry replayed;
+    entity existing = recorded.create<foo<0>>({ 1, 1 });
+    REQUIRE(entity{ replayed.create<foo<0>>({ 1, 1 }) } == existing);
+
+    command_log log;
+    command_buffer::set_log(&log);
+    command_writer commands{ recorded };
+
+    int input = 1;
+    log.begin_frame(std::as_bytes(std::span{ &input, 1 }));
+    entity created = commands.create<foo<0>, label>({ 2, 3 }, label{ "created" });
+    commands.get_entity(existing).set<foo<2>>(4, 5);
+    command_buffer::flush(recorded);
+
+    input = 2;
+    log.begin_frame(std::as_bytes(std::span{ &input, 1 }));
+    entity cloned = commands.get_entity(created).clone().set<foo<1>>(6, 7);
+    commands.get_entity(existing).remove<foo<0>>();
+    command_buffer::flush(recorded);
+
+    input = 3;
+    log.begin_frame(std::as_bytes(std::span{ &input, 1 }));
+    commands.destroy(created);
+    command_buffer::flush(recorded);
+
+    command_buffer::set_log(nullptr);
+    REQUIRE(log.frames() == 3);
+
+    std::stringstream file;
+    log.save(file);
+    command_log_player player{ command_log::load(file) };
+
+    std::vector<int> inputs;
+    while (auto frame_inputs = player.next_frame(replayed)) {
+        REQUIRE(frame_inputs->size() == sizeof(int));
+        std::memcpy(&inputs.emplace_back(), frame_inputs->data(), sizeof(int));
+    }
+    REQUIRE(inputs == std::vector{ 1, 2, 3 });
+    REQUIRE_FALSE(recorded.alive(created));
+    REQUIRE(replayed.size() == recorded.size());
+
+    auto replayed_existing = replayed.get_entity(existing);
+    REQUIRE_FALSE(replayed_existing.has<foo<0>>());
+    REQUIRE(replayed_existing.get<foo<2>>() == foo<2>{ 4, 5 });
+
+    std::size_t clones{};
+    replayed.each([&](const foo<0>& f0, const foo<1>& f1, const label& text) {
+        REQUIRE(f0 == recorded.get_entity(cloned).get<foo<0>>());
+        REQUIRE(f1 == foo<1>{ 6, 7 });
+        REQUIRE(text.text == "created");
+        clones++;
+    });
+    REQUIRE(clones == 1);
+
+    SECTION("Unserializable component") {
+        command_log unserializable_log;
+        command_buffer::set_log(&unserializable_log);
+        unserializable_log.begin_frame();
+        commands.create<bar<0>>({ 1, 2 });
+        command_buffer::flush(recorded);
+        command_buffer::set_log(nullptr);
+
+        auto bytes = unserializable_log.bytes();
+        command_log_player unserializable_player{ { bytes.begin(), bytes.end() } };
+        REQUIRE_THROWS_AS(unserializable_player.next_frame(replayed), replay_error);
+    }
+}
+
+TEST_CASE("Command journal recovery") {
+    component_serializers::add<foo<0>>();
+    component_serializers::add<foo<1>>();
+
+    auto path = (std::filesystem::temp_directory_path() / "co_ecs_test.journal").string();
+
+    // the snapshot the journal starts from
+    co_ecs::registry registry;
+    co_ecs::registry recovered;
+    entity existing = registry.create<foo<0>>({ 1, 1 });
+    REQUIRE(entity{ recovered.create<foo<0>>({ 1, 1 }) } == existing);
+
+    entity created;
+    {
+        co_ecs::journal journal{ registry, path };
+        command_writer commands{ registry };
+
+        created = commands.create<foo<0>>({ 2, 2 });
+        command_buffer::flush(registry);
+        registry.get_entity(existing).get<foo<0>>() = foo<0>{ 3, 3 };
+        journal.commit(registry);
+
+        commands.get_entity(created).set<foo<1>>(4, 4);
+        command_buffer::flush(registry);
+        registry.get_entity(created).get<foo<0>>().a = 5;
+        journal.commit(registry);
+
+        journal.wait();
+        REQUIRE(journal.durable() == 2);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    auto journal_bytes = contents.str();
+
+    SECTION("Replay all frames") {
+        std::istringstream in(journal_bytes);
+        command_log_player player{ journal::recover(in) };
+        while (player.next_frame(recovered)) {
+        }
+
+        REQUIRE(recovered.size() == 2);
+        REQUIRE(recovered.get_entity(existing).get<foo<0>>() == foo<0>{ 3, 3 });
+        std::size_t matched{};
+        recovered.each([&](const foo<0>& f0, const foo<1>& f1) {
+            REQUIRE(f0 == foo<0>{ 5, 2 });
+            REQUIRE(f1 == foo<1>{ 4, 4 });
+            matched++;
+        });
+        REQUIRE(matched == 1);
+    }
+
+    SECTION("Drop torn frame") {
+        std::istringstream in(journal_bytes.substr(0, journal_bytes.size() - 1));
+        command_log_player player{ journal::recover(in) };
+        while (player.next_frame(recovered)) {
+        }
+
+        REQUIRE(recovered.size() == 2);
+        REQUIRE(recovered.get_entity(existing).get<foo<0>>() == foo<0>{ 3, 3 });
+        std::size_t matched{};
+        recovered.each([&](const foo<0>& f0) {
+            if (f0 == foo<0>{ 2, 2 }) {
+                matched++;
+            }
+        });
+        REQUIRE(matched == 1);
+    }
+
+    std::filesystem::remove(path);
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 #include <co_ecs/co_ecs.hpp>
+#include <co_ecs/detail/codec.hpp>
 #include <co_ecs/detail/work_stealing_queue.hpp>
 
 using namespace co_ecs;
@@ -451,4 +452,29 @@ TEST_CASE("Work stealing queue", "Push/pop/steal") {
 
     REQUIRE(q.steal() == std::nullopt);
     REQUIRE(q.pop() == std::nullopt);
-}
\ No newline at end of file
+}
+TEST_CASE("Delta RLE codec", "Encode and decode arrays of elements") {
+    using co_ecs::detail::delta_rle_codec;
+
+    const std::size_t stride = GENERATE(1, 4, 12);
+    const std::size_t count = GENERATE(1, 7, 1000);
+
+    std::vector<std::byte> input(stride * count);
+    for (std::size_t i = 0; i < input.size(); i++) {
+        // slowly changing fields mixed with noise and long runs
+        auto element = i / stride;
+        auto field = i % stride;
+        auto value = field == 0 ? element : field == 1 ? (element * 2654435761U) >> 7 : element / 100;
+        input[i] = static_cast<std::byte>(value);
+    }
+
+    std::vector<std::byte> encoded{ std::byte{ 0xAB } };
+    delta_rle_codec::encode(input.data(), input.size(), stride, encoded);
+
+    std::vector<std::byte> output(input.size());
+    const std::byte* in = encoded.data() + 1;
+    delta_rle_codec::decode(in, output.data(), output.size(), stride);
+
+    REQUIRE(in == encoded.data() + encoded.size());
+    REQUIRE(output == input);
+}
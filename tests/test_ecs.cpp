@@ -3,6 +3,8 @@
 #include <catch2/catch_all.hpp>
 #include <co_ecs/co_ecs.hpp>
 
+#include <sstream>
+
 using namespace co_ecs;
 
 TEST_CASE("ECS Registry", "Creation and destruction of entities") {
@@ -182,11 +184,12 @@ TEST_CASE("ECS Registry insufficient chunk size",
     "Catch exceptions raised when entity components can not fit in a chunk") {
     registry test_registry;
 
-    struct first_big_struct {
+    // Over aligned components are never stored out of line
+    struct alignas(128) first_big_struct {
         std::array<char, 8192> data{};
     };
 
-    struct second_big_struct {
+    struct alignas(128) second_big_struct {
         std::array<char, 8192> data{};
     };
 
@@ -197,6 +200,17 @@ TEST_CASE("ECS Registry insufficient chunk size",
 
     REQUIRE_THROWS_AS((test_registry.create<first_big_struct, second_big_struct>({}, {})), insufficient_chunk_size);
     REQUIRE_THROWS_AS(test_registry.get_entity(ent).set<second_big_struct>(), insufficient_chunk_size);
+
+    // Big components with regular alignment are stored out of line and fit
+    struct first_out_of_line_struct {
+        std::array<char, 8192> data{};
+    };
+
+    struct second_out_of_line_struct {
+        std::array<char, 8192> data{};
+    };
+
+    REQUIRE_NOTHROW(test_registry.create<first_out_of_line_struct, second_out_of_line_struct>({}, {}));
 }
 
 TEST_CASE("ECS Registry constraints", "Non-copiable components") {
@@ -303,3 +317,620 @@ TEST_CASE("ECS Registry clone") {
     REQUIRE(reg.get_entity(e2).get<foo<0>>() == foo<0>{ 1, 2 });
     REQUIRE(reg.get_entity(e2).get<foo<1>>() == foo<1>{ 3, 4 });
 }
+
+TEST_CASE("ECS column visitation") {
+    registry reg;
+
+    std::vector<entity> entities;
+    for (int i = 0; i < 10000; i++) {
+        entities.push_back(reg.create<foo<0>, foo<1>>({ i, 0 }, { i, 1 }));
+    }
+    entities.push_back(reg.create<foo<1>>({ -1, 1 }));
+
+    std::size_t visited{};
+    std::size_t columns{};
+    std::as_const(reg).visit_columns([&](std::span<const entity> chunk_entities, const_component_column column) {
+        REQUIRE(column.count == chunk_entities.size());
+        REQUIRE(column.stride == sizeof(foo<0>));
+        columns++;
+        for (std::size_t i = 0; i < column.count; i++) {
+            const auto& expected = reg.get_entity(chunk_entities[i]);
+            if (column.meta == component_meta::of<foo<0>>()) {
+                REQUIRE(*static_cast<const foo<0>*>(column.at(i)) == expected.get<foo<0>>());
+            } else {
+                REQUIRE(column.meta == component_meta::of<foo<1>>());
+                REQUIRE(*static_cast<const foo<1>*>(column.at(i)) == expected.get<foo<1>>());
+            }
+            visited++;
+        }
+    });
+    REQUIRE(visited == 20001);
+
+    // columns of a chunk are visited once each, entity handles are not a column
+    const auto& chunk = reg.get_entity(entities.front()).archetype().chunks().front();
+    std::size_t chunk_columns{};
+    chunk.visit_columns([&](const_component_column) { chunk_columns++; });
+    REQUIRE(chunk_columns == 2);
+
+    reg.visit_columns([](std::span<const entity>, component_column column) {
+        if (column.meta == component_meta::of<foo<0>>()) {
+            for (std::size_t i = 0; i < column.count; i++) {
+                static_cast<foo<0>*>(column.at(i))->b = 42;
+            }
+        }
+    });
+    REQUIRE(reg.get_entity(entities.front()).get<foo<0>>().b == 42);
+    REQUIRE(reg.get_entity(entities[9999]).get<foo<0>>().b == 42);
+    REQUIRE(columns > 2);
+}
+
+TEST_CASE("ECS Views parallel extract") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+
+    const int number_of_entities = GENERATE(0, 1, 10000);
+
+    for (int i = 0; i < number_of_entities; i++) {
+        if (i % 2) {
+            reg.create<foo<0>, name>({ i, -i }, { std::to_string(i) });
+        } else {
+            reg.create<foo<0>, foo<1>, name>({ i, -i }, {}, { std::to_string(i) });
+        }
+    }
+
+    auto view = reg.view<const foo<0>&, const name&>();
+    REQUIRE(view.size() == number_of_entities);
+
+    double_buffer<std::vector<foo<0>>> foos;
+    std::vector<entity> ids;
+    std::vector<name> names;
+
+    auto size = view.par_extract(ids, foos.back(), names);
+    foos.swap();
+
+    REQUIRE(size == number_of_entities);
+    REQUIRE(foos.front().size() == size);
+    REQUIRE(foos.back().empty());
+    REQUIRE(ids.size() == size);
+    REQUIRE(names.size() == size);
+
+    for (std::size_t i = 0; i < size; i++) {
+        REQUIRE(reg.get_entity(ids[i]).get<foo<0>>() == foos.front()[i]);
+        REQUIRE(std::to_string(foos.front()[i].a) == names[i].value);
+    }
+}
+
+TEST_CASE("ECS chunk aggregate") {
+    registry reg;
+
+    std::vector<entity> entities;
+    for (int i = 0; i < 10000; i++) {
+        entities.push_back(reg.create<foo<0>>({ i, 0 }));
+    }
+    for (int i = 0; i < 100; i++) {
+        reg.create<foo<0>, foo<1>>({ -i, 0 }, {});
+    }
+
+    constexpr auto lowest = std::numeric_limits<int>::min();
+    auto max_a = make_chunk_aggregate<foo<0>>(
+        lowest, [](const foo<0>& f) { return f.a; }, [](int a, int b) { return std::max(a, b); });
+    auto any_negative_b =
+        make_chunk_aggregate<foo<0>>(false, [](const foo<0>& f) { return f.b < 0; }, std::logical_or{});
+
+    REQUIRE(max_a.get(reg) == 9999);
+    REQUIRE_FALSE(any_negative_b.get(reg));
+
+    auto recomputed = max_a.recomputed();
+    REQUIRE(recomputed > 2);
+
+    // nothing changed, summaries are reused
+    REQUIRE(max_a.get(reg) == 9999);
+    REQUIRE(max_a.recomputed() == recomputed);
+
+    // mutable access dirties only the chunk of the entity
+    reg.get_entity(entities[42]).get<foo<0>>().a = 20000;
+    REQUIRE(max_a.get(reg) == 20000);
+    REQUIRE(max_a.recomputed() == recomputed + 1);
+
+    reg.get_entity(entities[43]).get<foo<0>>().b = -1;
+    REQUIRE(any_negative_b.get(reg));
+
+    // structural changes are picked up
+    reg.destroy(entities[42]);
+    REQUIRE(max_a.get(reg) == 9999);
+
+    const registry& c_reg = reg;
+    c_reg.each([](const foo<0>&) {});
+    auto before = max_a.recomputed();
+    REQUIRE(max_a.get(reg) == 9999);
+    REQUIRE(max_a.recomputed() == before);
+}
+
+TEST_CASE("ECS chunk compression") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+
+    std::vector<entity> entities;
+    for (int i = 0; i < 10000; i++) {
+        entities.push_back(reg.create<foo<0>, foo<1>>({ i, 0 }, { 0, i / 100 }));
+    }
+    auto named = reg.create<foo<0>, name>({ 1, 2 }, { "name" });
+
+    chunk_compressor compressor{ 2 };
+    auto stats = chunk::compression_statistics();
+
+    REQUIRE(compressor.sweep(reg) == 0);
+    REQUIRE(compressor.sweep(reg) == 0);
+    auto compressed = compressor.sweep(reg);
+    REQUIRE(compressed > 1);
+
+    auto after = chunk::compression_statistics();
+    REQUIRE(after.compressions == stats.compressions + compressed);
+    REQUIRE(after.compressed_bytes * 2 < after.uncompressed_bytes);
+    REQUIRE(after.ratio() > 2.0);
+
+    // chunks with non trivially copyable components are never compressed
+    for (const auto& chunk : reg.get_entity(named).archetype().chunks()) {
+        REQUIRE_FALSE(chunk.compressed());
+    }
+
+    // structural changes on compressed chunks
+    reg.destroy(entities[42]);
+    reg.create<foo<0>, foo<1>>({ 42, 0 }, { 0, 0 });
+    REQUIRE(reg.get_entity(entities[43]).get<foo<1>>().b == 0);
+    REQUIRE(reg.get_entity(entities.back()).get<foo<0>>().a == 9999);
+
+    // decompressed on access
+    std::size_t count{};
+    std::as_const(reg).each([&](const foo<0>& a, const foo<1>& b) {
+        REQUIRE(b.b == a.a / 100);
+        count++;
+    });
+    REQUIRE(count == entities.size());
+    REQUIRE(chunk::compression_statistics().stalls >= after.stalls + compressed);
+
+    // chunks woken up by an access stay resident
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(compressor.sweep(reg) == 0);
+    }
+    auto stalls = chunk::compression_statistics().stalls;
+    std::as_const(reg).each([&](const foo<0>&, const foo<1>&) {});
+    REQUIRE(chunk::compression_statistics().stalls == stalls);
+}
+
+TEST_CASE("ECS out of line components") {
+    struct big {
+        std::array<int, 512> values{};
+        std::string name;
+    };
+    static_assert(sizeof(big) > chunk::out_of_line_threshold);
+
+    registry reg;
+
+    std::vector<entity> entities;
+    for (int i = 0; i < 5000; i++) {
+        big b;
+        b.values.fill(i);
+        b.name = std::to_string(i);
+        entities.push_back(reg.create<foo<0>, big>({ i, 0 }, std::move(b)));
+    }
+
+    // the big component does not shrink the chunk capacity
+    auto& archetype = reg.get_entity(entities.front()).archetype();
+    auto& small_archetype = reg.get_entity(reg.create<foo<0>>({})).archetype();
+    REQUIRE(archetype.chunks().front().max_size() * 2 > small_archetype.chunks().front().max_size());
+    REQUIRE(detail::slab_pool::get().used_bytes() >= 5000 * sizeof(big));
+
+    auto check = [&](const std::vector<entity>& alive) {
+        std::size_t count{};
+        reg.each([&](const foo<0>& f, const big& b) {
+            REQUIRE(b.values.back() == f.a);
+            REQUIRE(b.name == std::to_string(f.a));
+            count++;
+        });
+        REQUIRE(count == alive.size());
+        for (auto ent : alive) {
+            auto [f, b] = reg.get_entity(ent).get<foo<0>, big>();
+            REQUIRE(b.values.front() == f.a);
+        }
+    };
+    check(entities);
+
+    // moving between archetypes and destroying entities keeps out of line components intact
+    std::vector<entity> kept;
+    for (std::size_t i = 0; i < entities.size(); i++) {
+        if (i % 4 == 0) {
+            reg.get_entity(entities[i]).set<foo<1>>();
+            kept.push_back(entities[i]);
+        } else if (i % 4 == 1) {
+            kept.push_back(entities[i]);
+        } else {
+            reg.destroy(entities[i]);
+        }
+    }
+    check(kept);
+
+    auto used_bytes = detail::slab_pool::get().used_bytes();
+    reg.destroy(kept);
+    REQUIRE(detail::slab_pool::get().used_bytes() < used_bytes);
+
+    auto ent = reg.create<big>({});
+    reg.get_entity(ent).get<big>().name = "name";
+    REQUIRE(reg.get_entity(ent).get<big>().name == "name");
+}
+
+TEST_CASE("ECS chunk NUMA placement") {
+    const auto& topology = detail::numa::topology::get();
+    REQUIRE(topology.num_nodes() >= 1);
+    REQUIRE(topology.current_node() < topology.num_nodes());
+    REQUIRE(thread_pool::current_worker().node() < topology.num_nodes());
+
+    registry reg;
+    for (int i = 0; i < 10000; i++) {
+        reg.create<foo<0>>({ i, 0 });
+    }
+
+    auto& chunks = reg.archetypes().ensure_archetype<foo<0>>()->chunks();
+    const auto last_node = topology.num_nodes() - 1;
+    for (auto& chunk : chunks) {
+        chunk.bind(last_node);
+    }
+
+    // chunks created afterwards continue on the node of the previous one
+    for (int i = 0; i < 10000; i++) {
+        reg.create<foo<0>>({ i, 0 });
+    }
+    for (auto& chunk : chunks) {
+        REQUIRE(chunk.node() == (topology.enabled() ? last_node : detail::numa::unknown_node));
+    }
+
+    for (int pass = 0; pass < chunk::node_migration_threshold; pass++) {
+        reg.view<foo<0>&>().par_each([](foo<0>& f) { f.b++; });
+    }
+    reg.each([](const foo<0>& f) { REQUIRE(f.b == chunk::node_migration_threshold); });
+}
+
+TEST_CASE("ECS Registry batch destroy") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+
+    const int number_of_entities = GENERATE(1, 100, 10000);
+
+    std::vector<entity> entities;
+    for (int i = 0; i < number_of_entities; i++) {
+        if (i % 3) {
+            entities.push_back(reg.create<foo<0>, name>({ i, 0 }, { std::to_string(i) }));
+        } else {
+            entities.push_back(reg.create<foo<0>, foo<1>, name>({ i, 0 }, {}, { std::to_string(i) }));
+        }
+    }
+
+    std::vector<entity> destroyed;
+    std::vector<entity> kept;
+    for (int i = 0; i < number_of_entities; i++) {
+        (i % 5 < 3 ? destroyed : kept).push_back(entities[i]);
+    }
+    // duplicates are destroyed once
+    if (!destroyed.empty()) {
+        destroyed.push_back(destroyed.front());
+    }
+
+    reg.destroy(destroyed);
+
+    REQUIRE(reg.size() == kept.size());
+    for (auto ent : destroyed) {
+        REQUIRE_FALSE(reg.alive(ent));
+    }
+    for (auto ent : kept) {
+        REQUIRE(reg.alive(ent));
+        auto [f, n] = reg.get_entity(ent).get<foo<0>, name>();
+        REQUIRE(std::to_string(f.a) == n.value);
+    }
+
+    std::size_t count{};
+    reg.each([&](const entity& ent, const foo<0>&) {
+        REQUIRE(reg.alive(ent));
+        count++;
+    });
+    REQUIRE(count == kept.size());
+
+    REQUIRE_THROWS_AS(reg.destroy(destroyed), entity_not_found);
+
+    reg.destroy(kept);
+    REQUIRE(reg.empty());
+
+    // recycled IDs are reused
+    auto ent = reg.create<foo<0>>({ 1, 2 });
+    REQUIRE(reg.get_entity(ent).get<foo<0>>() == foo<0>{ 1, 2 });
+}
+
+TEST_CASE("ECS Registry batch destroy after single destroys") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+
+    auto first = reg.create<foo<0>, name>({ 0, 0 }, { "0" });
+    const auto max_size = static_cast<int>(reg.get_entity(first).archetype().chunks().front().max_size());
+
+    std::vector<entity> entities{ first };
+    for (int i = 1; i < max_size * 3; i++) {
+        entities.push_back(reg.create<foo<0>, name>({ i, 0 }, { std::to_string(i) }));
+    }
+
+    // removing the last entity of a chunk that is not the last one keeps the chunk full
+    std::vector<entity> destroyed{ entities[max_size - 1], entities[2 * max_size - 1], entities[0] };
+    for (auto ent : destroyed) {
+        reg.destroy(ent);
+    }
+    const auto& chunks = reg.get_entity(entities[1]).archetype().chunks();
+    REQUIRE(chunks[0].full());
+    REQUIRE(chunks[1].full());
+
+    std::vector<entity> batch;
+    std::vector<entity> kept;
+    for (int i = 1; i < max_size * 3; i++) {
+        if (i == max_size - 1 || i == 2 * max_size - 1) {
+            continue;
+        }
+        (i % 3 == 0 ? batch : kept).push_back(entities[i]);
+    }
+    reg.destroy(batch);
+
+    REQUIRE(reg.size() == kept.size());
+    for (auto ent : batch) {
+        REQUIRE_FALSE(reg.alive(ent));
+    }
+    for (auto ent : kept) {
+        REQUIRE(reg.alive(ent));
+        auto [f, n] = reg.get_entity(ent).get<foo<0>, name>();
+        REQUIRE(std::to_string(f.a) == n.value);
+        REQUIRE(f.a % 3 != 0);
+    }
+
+    std::size_t count{};
+    reg.each([&](const entity& ent, const foo<0>& f, const name& n) {
+        REQUIRE(reg.alive(ent));
+        REQUIRE(std::to_string(f.a) == n.value);
+        count++;
+    });
+    REQUIRE(count == kept.size());
+}
+
+TEST_CASE("ECS Registry clear") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+
+    std::vector<entity> entities;
+    for (int i = 0; i < 10000; i++) {
+        entities.push_back(reg.create<foo<0>, name>({ i, 0 }, { std::to_string(i) }));
+        entities.push_back(reg.create<foo<0>, foo<1>>({ i, 0 }, {}));
+    }
+    const auto archetypes_count = reg.archetypes().size();
+
+    reg.clear();
+
+    REQUIRE(reg.empty());
+    REQUIRE(reg.archetypes().size() == archetypes_count);
+    for (auto ent : entities) {
+        REQUIRE_FALSE(reg.alive(ent));
+    }
+    REQUIRE_THROWS_AS(reg.destroy(entities.front()), entity_not_found);
+
+    std::size_t count{};
+    reg.each([&](const foo<0>&) { count++; });
+    REQUIRE(count == 0);
+
+    // next match reuses IDs and chunks
+    std::vector<entity> recreated;
+    for (int i = 0; i < 10000; i++) {
+        recreated.push_back(reg.create<foo<0>, name>({ i, 0 }, { std::to_string(i) }));
+    }
+    REQUIRE(reg.size() == recreated.size());
+    REQUIRE(recreated.front().id() == 0);
+    for (auto ent : recreated) {
+        auto [f, n] = reg.get_entity(ent).get<foo<0>, name>();
+        REQUIRE(std::to_string(f.a) == n.value);
+    }
+    for (auto ent : entities) {
+        REQUIRE_FALSE(reg.alive(ent));
+    }
+}
+
+TEST_CASE("ECS value index") {
+    registry reg;
+
+    auto first = reg.create<foo<0>>({ 1, 10 });
+    auto second = reg.create<foo<0>, foo<1>>({ 2, 20 }, { 0, 0 });
+
+    // existing entities are indexed when the index is added
+    reg.add_index<foo<0>>(&foo<0>::a);
+    REQUIRE(reg.lookup<foo<0>>(1) == first);
+    REQUIRE(reg.lookup<foo<0>>(2) == second);
+    REQUIRE(reg.lookup<foo<0>>(3) == std::nullopt);
+    REQUIRE_THROWS_AS(reg.lookup<foo<1>>(1), index_not_found);
+
+    // create, set, remove and destroy maintain the index
+    auto third = reg.create<foo<0>>({ 3, 30 });
+    REQUIRE(reg.lookup<foo<0>>(3) == third);
+
+    first.set<foo<0>>(4, 10);
+    REQUIRE(reg.lookup<foo<0>>(1) == std::nullopt);
+    REQUIRE(reg.lookup<foo<0>>(4) == first);
+
+    second.remove<foo<0>>();
+    REQUIRE(reg.lookup<foo<0>>(2) == std::nullopt);
+    second.set<foo<0>>(2, 20);
+    REQUIRE(reg.lookup<foo<0>>(2) == second);
+
+    third.destroy();
+    REQUIRE(reg.lookup<foo<0>>(3) == std::nullopt);
+
+    auto clone = first.clone();
+    REQUIRE(reg.lookup<foo<0>>(4) == clone);
+
+    // in place changes need a reindex
+    reg.get_entity(clone).get<foo<0>>().a = 5;
+    reg.reindex(clone);
+    REQUIRE(reg.lookup<foo<0>>(5) == clone);
+
+    // commands are indexed once the flush completes
+    command_writer cmd{ reg };
+    auto spawned = cmd.create<foo<0>>({ 6, 60 });
+    cmd.get_entity(first).set<foo<0>>(7, 70);
+    cmd.destroy(second);
+    command_buffer::flush(reg);
+    REQUIRE(reg.lookup<foo<0>>(6) == static_cast<entity>(spawned));
+    REQUIRE(reg.lookup<foo<0>>(7) == first);
+    REQUIRE(reg.lookup<foo<0>>(4) == std::nullopt);
+    REQUIRE(reg.lookup<foo<0>>(2) == std::nullopt);
+
+    reg.clear();
+    REQUIRE(reg.lookup<foo<0>>(6) == std::nullopt);
+
+    reg.remove_index<foo<0>>();
+    REQUIRE_THROWS_AS(reg.lookup<foo<0>>(6), index_not_found);
+}
+
+TEST_CASE("ECS chunk layout") {
+    struct name {
+        std::string value;
+    };
+
+    registry reg;
+    std::vector<entity> entities;
+    for (int i = 0; i < 1000; i++) {
+        entities.push_back(reg.create<foo<0>, foo<1>, foo<2>, foo<3>, foo<4>, name>(
+            { i, 0 }, { i, 1 }, { i, 2 }, { i, 3 }, { i, 4 }, { std::to_string(i) }));
+    }
+
+    access_profile::reset();
+    access_profile::enable(true);
+    for (int frame = 0; frame < 3; frame++) {
+        reg.each([](foo<0>& f0, const foo<4>& f4) { f0.b += f4.b; });
+    }
+    reg.each([](const foo<1>&, const name&) {});
+
+    auto before = chunk_layout::statistics(reg);
+    REQUIRE(before.accesses == 4);
+    REQUIRE(before.hit_rate() < 1.0);
+
+    REQUIRE(chunk_layout::optimize(reg) == 1);
+    REQUIRE(chunk_layout::optimize(reg) == 0);
+
+    auto after = chunk_layout::statistics(reg);
+    REQUIRE(after.accesses == 4);
+    REQUIRE(after.hit_rate() == 1.0);
+
+    // components survive the move into the new layout
+    for (int i = 0; i < 1000; i++) {
+        auto ent = reg.get_entity(entities[i]);
+        REQUIRE(ent.get<foo<0>>() == foo<0>{ i, 12 });
+        REQUIRE(ent.get<foo<3>>() == foo<3>{ i, 3 });
+        REQUIRE(ent.get<name>().value == std::to_string(i));
+    }
+
+    // archetypes created while recording get the layout right away
+    auto created = reg.create<foo<0>, foo<2>, foo<4>>({}, {}, {});
+    auto order = created.archetype().block_order();
+    auto position = [&](component_id_t id) { return std::ranges::find(order, id) - order.begin(); };
+    REQUIRE(std::abs(position(component_meta::of<foo<0>>().id) - position(component_meta::of<foo<4>>().id)) == 1);
+
+    access_profile::enable(false);
+    access_profile::reset();
+}
+
+TEST_CASE("ECS in place construction") {
+    struct pinned {
+        std::array<int, 64> data;
+        std::string label;
+        int moves{};
+
+        pinned(int fill, std::string label) noexcept : label(std::move(label)) {
+            data.fill(fill);
+        }
+        pinned(pinned&& other) noexcept : data(other.data), label(std::move(other.label)), moves(other.moves + 1) {
+        }
+        pinned& operator=(pinned&& other) noexcept {
+            data = other.data;
+            label = std::move(other.label);
+            moves = other.moves + 1;
+            return *this;
+        }
+    };
+
+    registry reg;
+    std::string label = "first";
+
+    auto ent = reg.create(in_place<pinned>(7, label), foo<0>{ 1, 2 });
+    REQUIRE(ent.get<pinned>().moves == 0);
+    REQUIRE(ent.get<pinned>().data[63] == 7);
+    REQUIRE(ent.get<pinned>().label == "first");
+    REQUIRE(label == "first");
+    REQUIRE(ent.get<foo<0>>() == foo<0>{ 1, 2 });
+
+    auto moved = reg.create(in_place<pinned>(3, std::move(label)));
+    REQUIRE(moved.get<pinned>().moves == 0);
+    REQUIRE(moved.get<pinned>().label == "first");
+
+    auto with_value = reg.create<pinned>({ 1, "value" });
+    REQUIRE(with_value.get<pinned>().moves == 1);
+}
+
+TEST_CASE("ECS columnar import and export") {
+    registry reg;
+    reg.add_index<foo<0>>(&foo<0>::a);
+
+    std::vector<foo<0>> first;
+    std::vector<foo<1>> second;
+    for (int i = 0; i < 10000; i++) {
+        first.emplace_back(i, 0);
+        second.emplace_back(i, 1);
+    }
+    auto created = reg.create_columns<foo<0>, foo<1>>(first, second);
+    REQUIRE(created.size() == 10000);
+    REQUIRE(reg.get_entity(created[1234]).get<foo<0>>() == foo<0>{ 1234, 0 });
+    REQUIRE(reg.get_entity(created[9999]).get<foo<1>>() == foo<1>{ 9999, 1 });
+    REQUIRE(reg.lookup<foo<0>>(5000) == created[5000]);
+    REQUIRE_THROWS_AS((reg.create_columns<foo<0>, foo<1>>(first, std::span(second).first(10))), std::invalid_argument);
+
+    std::stringstream file;
+    columnar::save<foo<0>, foo<1>>(reg, file);
+
+    registry other;
+    other.create<foo<0>>({ -1, -1 });
+    auto imported = columnar::load<foo<1>, foo<0>>(other, file);
+    REQUIRE(imported.size() == 10000);
+    for (int i = 0; i < 10000; i++) {
+        auto ent = other.get_entity(imported[i]);
+        REQUIRE(ent.get<foo<0>>() == foo<0>{ i, 0 });
+        REQUIRE(ent.get<foo<1>>() == foo<1>{ i, 1 });
+    }
+
+    // imported entities behave like any other
+    other.destroy(imported.front());
+    REQUIRE(other.get_entity(imported.back()).get<foo<0>>() == foo<0>{ 9999, 0 });
+
+    auto bytes = file.str();
+    auto data = std::as_bytes(std::span(bytes));
+    REQUIRE_THROWS_AS((columnar::load<foo<0>>(other, data)), columnar_error);
+    REQUIRE_THROWS_AS((columnar::load<foo<0>, foo<2>>(other, data)), columnar_error);
+    REQUIRE_THROWS_AS((columnar::load<foo<0>, foo<1>>(other, data.first(data.size() - 1))), columnar_error);
+
+    std::stringstream empty;
+    columnar::save<foo<3>>(reg, empty);
+    REQUIRE(columnar::load<foo<3>>(other, empty).empty());
+}
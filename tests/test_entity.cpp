@@ -46,7 +46,12 @@ TEST_CASE("Entity pool", "Test entity pool functionality - allocation and recycl
     REQUIRE_FALSE(pool.alive(e1));
     auto e3 = pool.create();
     REQUIRE(pool.alive(e3));
-    REQUIRE(e3.id() == e1.id());
+    // compact handles queue free IDs before reusing them
+    if constexpr (entity_pool::min_free_ids == 0) {
+        REQUIRE(e3.id() == e1.id());
+    } else {
+        REQUIRE(e3.id() != e1.id());
+    }
 
     auto e4 = pool.reserve();
     auto e5 = pool.reserve();
@@ -56,4 +61,66 @@ TEST_CASE("Entity pool", "Test entity pool functionality - allocation and recycl
     REQUIRE(pool.alive(e4));
     REQUIRE(pool.alive(e5));
     REQUIRE(pool.alive(e6));
-}
\ No newline at end of file
+}
+
+struct compact_tag_t {
+    using layout = detail::compact_handle_layout;
+};
+
+using compact_handle = detail::handle<compact_tag_t>;
+
+TEST_CASE("Entity compact handles", "Test 32-bit handles and generation wraparound") {
+    static_assert(sizeof(compact_handle) == sizeof(std::uint32_t));
+    static_assert(sizeof(detail::handle<struct wide_tag_t>) == sizeof(std::uint64_t));
+
+    auto h = compact_handle{ 0xABCDEF, 0x12 };
+    REQUIRE(h.id() == 0xABCDEF);
+    REQUIRE(h.generation() == 0x12);
+    REQUIRE(h.valid());
+    REQUIRE_FALSE(compact_handle{}.valid());
+    REQUIRE(compact_handle{ 1, 0 } > compact_handle{ 0, 200 });
+
+    using compact_pool = detail::handle_pool<compact_handle>;
+    constexpr auto min_free = compact_pool::min_free_ids;
+    static_assert(min_free > 0);
+    static_assert(detail::handle_pool<detail::handle<struct wide_tag_t>>::min_free_ids == 0);
+
+    compact_pool pool;
+    auto first = pool.create();
+    auto stale = first;
+
+    // a single churning handle cycles through a queue of free IDs and generations wrap around, IDs never run out and
+    // the stale handle stays dead until its ID went through the queue once per generation
+    constexpr std::size_t generations = compact_handle::invalid_generation + 1;
+    auto current = first;
+    std::size_t max_id{};
+    bool stale_alive{};
+    for (std::size_t i = 0; i < 2 * generations * (min_free + 1); i++) {
+        pool.recycle(current);
+        current = pool.create();
+        max_id = std::max<std::size_t>(max_id, current.id());
+        if (i < (generations - 1) * (min_free + 1)) {
+            stale_alive = stale_alive || pool.alive(stale);
+        }
+    }
+    REQUIRE_FALSE(stale_alive);
+    REQUIRE(max_id == min_free);
+    REQUIRE(pool.alive(current));
+
+    // reserved handles take queued IDs
+    pool.recycle(current);
+    auto reserved = pool.reserve();
+    pool.flush();
+    REQUIRE(pool.alive(reserved));
+    REQUIRE(reserved.id() <= min_free);
+
+    // clear bumps generations without using up IDs
+    for (std::size_t i = 0; i < generations + 1; i++) {
+        pool.clear();
+    }
+    REQUIRE_FALSE(pool.alive(current));
+    REQUIRE_FALSE(pool.alive(reserved));
+    auto after_clear = pool.create();
+    REQUIRE(after_clear.id() == 0);
+    REQUIRE(pool.alive(after_clear));
+}
@@ -3,6 +3,9 @@
 #include <catch2/catch_all.hpp>
 #include <co_ecs/co_ecs.hpp>
 
+#include <algorithm>
+#include <limits>
+
 using namespace co_ecs;
 
 TEST_CASE("Schedule", "Basic schedule operations") {
@@ -79,6 +82,200 @@ TEST_CASE("Schedule stress: Entity commands scale") {
     REQUIRE(reg.get_entity(e).get<singleton>().entity_count == number_of_entities * (number_of_iterations - 1));
 }
 
+TEST_CASE("Main thread systems") {
+    thread_pool pool{ 4 };
+    registry reg;
+    auto main_thread = std::this_thread::get_id();
+
+    std::vector<int> order;
+    std::mutex order_mutex;
+    auto record = [&](int id) {
+        std::lock_guard lock(order_mutex);
+        order.push_back(id);
+    };
+
+    int main_runs{};
+    bool on_main_thread{ true };
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([&](view<foo<0>&>) { record(0); })
+                    .add_system([&](view<foo<0>&>) { record(1); })
+                    .add_system([&](view<foo<0>&>) { record(2); })
+                    .add_system(main_thread_execution_policy,
+                        [&](view<const foo<1>&>) {
+                            main_runs++;
+                            on_main_thread = on_main_thread && std::this_thread::get_id() == main_thread;
+                        })
+                    .add_system(main_thread_execution_policy,
+                        [&](view<const foo<0>&>) {
+                            on_main_thread = on_main_thread && std::this_thread::get_id() == main_thread;
+                            record(3);
+                        })
+                    .end_stage()
+                    .create_executor(reg);
+
+    for (int frame = 0; frame < 3; frame++) {
+        exec->run_once();
+    }
+
+    // main thread systems run once per frame and respect access conflicts like any other system
+    REQUIRE(main_runs == 3);
+    REQUIRE(on_main_thread);
+    REQUIRE(order == std::vector<int>{ 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3 });
+
+    // workers can hand work over to the main thread
+    std::thread::id ran_on{};
+    auto* task = pool.submit([&]() {
+        pool.wait(pool.submit_to_main([&]() { ran_on = std::this_thread::get_id(); }, thread_pool::current_task()));
+    });
+    pool.wait(task);
+    REQUIRE(ran_on == main_thread);
+}
+
+TEST_CASE("Automatic sync points") {
+    registry reg;
+
+    std::size_t seen{};
+    auto exec = schedule()
+                    .auto_sync()
+                    .begin_stage()
+                    .add_system([](command_writer cmd) {
+                        for (int i = 0; i < 10; i++) {
+                            cmd.create<foo<0>>({ i, 0 });
+                        }
+                    })
+                    .end_stage()
+                    .begin_stage()
+                    .add_system([](view<foo<1>&>) {})
+                    .end_stage()
+                    .begin_stage()
+                    .add_system([&seen](view<const foo<0>&> v) { seen = std::ranges::distance(v.each()); })
+                    .end_stage()
+                    .create_executor(reg);
+
+    // spawned entities are visible in the same run, only the stage reading foo<0> waits for a flush
+    exec->run_once();
+    REQUIRE(seen == 10);
+    REQUIRE(exec->sync_points() == 1);
+
+    exec->run_once();
+    REQUIRE(seen == 20);
+    REQUIRE(exec->sync_points() == 2);
+
+    access_pattern_t writes_foo(access_type::write, component_meta::of<foo<0>>());
+    REQUIRE(writes_foo.conflicts(access_pattern_t(access_type::read, component_meta::of<foo<0>>())));
+    REQUIRE_FALSE(writes_foo.conflicts(access_pattern_t(access_type::read, component_meta::of<foo<1>>())));
+    access_pattern_t writes_all(access_type::write);
+    REQUIRE(writes_all.conflicts(access_pattern_t(access_type::read, component_meta::of<foo<1>>())));
+    REQUIRE_FALSE(writes_all.conflicts(access_pattern_t{}));
+}
+
+TEST_CASE("Asynchronous frame") {
+    thread_pool pool{ 4 };
+    registry reg;
+    auto main_thread = std::this_thread::get_id();
+
+    std::atomic<int> runs{};
+    bool main_on_main_thread{};
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([&runs](command_writer cmd) {
+                        cmd.create<foo<0>>({ 1, 2 });
+                        runs++;
+                    })
+                    .add_system(main_thread_execution_policy,
+                        [&](view<const foo<1>&>) { main_on_main_thread = std::this_thread::get_id() == main_thread; })
+                    .end_stage()
+                    .create_executor(reg);
+
+    // poll until done, main thread systems run while polling
+    std::vector<int> continuations;
+    auto frame = exec->run_async().then([&]() { continuations.push_back(1); });
+    frame.then([&]() { continuations.push_back(2); });
+    while (!frame.poll()) {
+    }
+    REQUIRE(runs == 1);
+    REQUIRE(main_on_main_thread);
+    REQUIRE(continuations == std::vector<int>{ 1, 2 });
+    REQUIRE(reg.size() == 1);
+
+    // chaining to a finished frame runs right away
+    frame.then([&]() { continuations.push_back(3); });
+    REQUIRE(continuations.size() == 3);
+
+    // waiting helps executing the frame, run_once waits for a frame in flight
+    auto second = exec->run_async();
+    exec->run_once();
+    REQUIRE(second.ready());
+    REQUIRE(runs == 3);
+    REQUIRE(reg.size() == 3);
+
+    auto third = exec->run_async();
+    third.wait();
+    REQUIRE(third.ready());
+    REQUIRE(reg.size() == 4);
+
+    REQUIRE(frame_handle{}.ready());
+}
+
+TEST_CASE("Asynchronous frame outlives task pool slots") {
+    thread_pool pool{ 2 };
+    registry reg;
+
+    std::atomic<bool> release{};
+    std::atomic<int> runs{};
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([&]() {
+                        while (!release.load()) {
+                            std::this_thread::yield();
+                        }
+                        runs++;
+                    })
+                    .end_stage()
+                    .create_executor(reg);
+
+    auto frame = exec->run_async();
+
+    // the submitting thread allocates more tasks than the task pool holds while the frame is in flight
+    for (std::size_t i = 0; i < task_pool::max_tasks + 1; i++) {
+        task_pool::allocate([]() {});
+    }
+
+    release = true;
+    frame.wait();
+    REQUIRE(frame.ready());
+    REQUIRE(runs == 1);
+}
+
+TEST_CASE("Concurrent writers of one chunk") {
+    thread_pool pool{ 4 };
+    registry reg;
+
+    for (int i = 0; i < 10000; i++) {
+        reg.create<foo<0>, foo<1>>({ i, 0 }, { 0, i });
+    }
+
+    constexpr auto lowest = std::numeric_limits<int>::min();
+    auto max = [](int a, int b) { return std::max(a, b); };
+    auto max_a = make_chunk_aggregate<foo<0>>(lowest, [](const foo<0>& f) { return f.a; }, max);
+    auto max_b = make_chunk_aggregate<foo<1>>(lowest, [](const foo<1>& f) { return f.b; }, max);
+
+    // both systems write different components of the same chunks in one batch
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([](view<foo<0>&> v) { v.par_each([](foo<0>& f) { f.a++; }); })
+                    .add_system([](view<foo<1>&> v) { v.par_each([](foo<1>& f) { f.b++; }); })
+                    .end_stage()
+                    .create_executor(reg);
+
+    for (int frame = 1; frame <= 3; frame++) {
+        exec->run_once();
+        REQUIRE(max_a.get(reg) == 9999 + frame);
+        REQUIRE(max_b.get(reg) == 9999 + frame);
+    }
+}
+
 TEST_CASE("Parallel for") {
     std::vector<std::uint64_t> vec;
 
@@ -93,4 +290,510 @@ TEST_CASE("Parallel for") {
     parallel_for(vec, [&sum](auto elem) { sum.fetch_add(elem); });
 
     REQUIRE(sum.load() == (number_of_elements) * (number_of_elements - 1) / 2);
-}
\ No newline at end of file
+}
+TEST_CASE("Parallelism hint") {
+    thread_pool pool{ 4 };
+    REQUIRE(pool.parallelism() == 4);
+    REQUIRE(pool.available_parallelism() >= 1);
+    REQUIRE(pool.available_parallelism() <= 4);
+
+    std::vector<std::uint64_t> vec(1000);
+    std::atomic<std::size_t> other_threads{};
+    {
+        // a caller sharing the pool with busy siblings runs its loop in place
+        parallelism_hint hint{ 1 };
+        REQUIRE(pool.parallelism() == 1);
+        REQUIRE(pool.available_parallelism() == 1);
+
+        auto caller = std::this_thread::get_id();
+        parallel_for(vec, [&](auto) {
+            if (std::this_thread::get_id() != caller) {
+                other_threads++;
+            }
+        });
+    }
+    REQUIRE(other_threads == 0);
+    REQUIRE(pool.parallelism() == 4);
+
+    // systems of a single batch split the workers between them
+    registry reg;
+    std::atomic<std::size_t> hints{};
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system([&hints](view<const foo<0>&>) { hints += parallelism_hint::current(); })
+                    .add_system([&hints](view<const foo<1>&>) { hints += parallelism_hint::current(); })
+                    .end_stage()
+                    .create_executor(reg);
+    exec->run_once();
+    REQUIRE(hints == 4);
+}
+
+TEST_CASE("Parallel for cancellation") {
+    std::vector<std::uint64_t> vec(GENERATE(10, 100000));
+
+    std::atomic<uint64_t> count{ 0 };
+
+    cancellation_source source;
+    source.request_stop();
+
+    parallel_for(vec, [&count](auto) { count.fetch_add(1); }, source.get_token());
+
+    REQUIRE(count.load() == 0);
+}
+
+TEST_CASE("Task cancellation propagates to children") {
+    cancellation_source source;
+
+    bool parent_executed{};
+    bool child_executed{};
+
+    task_t parent([&]() { parent_executed = true; }, nullptr, source.get_token());
+    task_t child([&]() { child_executed = true; }, &parent);
+
+    REQUIRE_FALSE(child.is_cancelled());
+
+    source.request_stop();
+
+    REQUIRE(parent.is_cancelled());
+    REQUIRE(child.is_cancelled());
+
+    child.execute();
+    parent.execute();
+
+    REQUIRE_FALSE(child_executed);
+    REQUIRE_FALSE(parent_executed);
+    REQUIRE(parent.is_completed());
+}
+
+TEST_CASE("Parallel each cancellation") {
+    registry reg;
+
+    for (auto i = 0; i < 10000; i++) {
+        reg.create<foo<0>>({ 1, 2 });
+    }
+
+    cancellation_source source;
+    source.request_stop();
+
+    reg.view<foo<0>&>().par_each([](auto& f) { f.a = 0; }, source.get_token());
+
+    reg.each([](const foo<0>& f) { REQUIRE(f.a == 1); });
+}
+
+TEST_CASE("Parallel for cancelled through the calling task") {
+    // a single worker leaves no idle workers, the nested loop runs its batches in place
+    thread_pool pool{ 1 };
+
+    std::vector<int> values(1000);
+    std::atomic<std::size_t> count{};
+    std::size_t parallelism{};
+    cancellation_source source;
+
+    auto* task = pool.submit(
+        [&]() {
+            parallelism = pool.available_parallelism();
+            parallel_for(
+                values,
+                [&](int) {
+                    if (count.fetch_add(1) == 0) {
+                        source.request_stop();
+                    }
+                },
+                fixed_partitioner{ 10 });
+        },
+        nullptr,
+        source.get_token());
+    pool.wait(task);
+
+    REQUIRE(parallelism == 1);
+    REQUIRE(count == 10);
+}
+
+TEST_CASE("Parallel each with affinity") {
+    registry reg;
+
+    for (auto i = 0; i < 100000; i++) {
+        reg.create<foo<0>>({ 0, i });
+    }
+
+    const std::size_t workers = GENERATE(1, 4);
+    thread_pool pool{ workers };
+
+    affinity_partitioner affinity;
+    const int frames = 10;
+    for (int frame = 0; frame < frames; frame++) {
+        reg.view<foo<0>&>().par_each([](foo<0>& f) { f.a++; }, affinity);
+    }
+
+    std::size_t count{};
+    reg.each([&](const foo<0>& f) {
+        REQUIRE(f.a == frames);
+        count++;
+    });
+    REQUIRE(count == 100000);
+
+    REQUIRE(affinity.hits() + affinity.misses() > 0);
+    if (workers == 1) {
+        REQUIRE(affinity.misses() == 0);
+    }
+
+    // history is reset when the number of batches changes
+    std::vector<int> values(GENERATE(0, 1, 1000));
+    std::atomic<std::size_t> sum{};
+    parallel_for(values, [&sum](int) { sum.fetch_add(1); }, affinity);
+    REQUIRE(sum == values.size());
+}
+
+TEST_CASE("Parallel reduce") {
+    std::vector<std::uint64_t> vec(GENERATE(0, 1, 10, 100000));
+    std::iota(vec.begin(), vec.end(), 0);
+
+    auto sum = parallel_reduce(
+        vec, std::uint64_t{}, [](auto elem) { return elem; }, std::plus{}, fixed_partitioner{ 64 });
+
+    REQUIRE(sum == std::accumulate(vec.begin(), vec.end(), std::uint64_t{}));
+}
+
+TEST_CASE("Parallel reduce is deterministic") {
+    std::vector<float> vec(10000);
+    for (std::size_t i = 0; i < vec.size(); i++) {
+        vec[i] = 1.0f / static_cast<float>(i + 1);
+    }
+
+    auto reduce = [&vec]() {
+        return parallel_reduce(vec, 0.0f, [](float v) { return v; }, std::plus{}, fixed_partitioner{ 128 });
+    };
+
+    float expected = reduce();
+    for (std::size_t workers = 1; workers <= 4; workers++) {
+        thread_pool pool{ workers };
+        REQUIRE(reduce() == expected);
+    }
+}
+
+TEST_CASE("Parallel reduce view") {
+    registry reg;
+
+    for (auto i = 0; i < 10000; i++) {
+        reg.create<foo<0>>({ i, 1 });
+    }
+
+    auto sum = reg.view<const foo<0>&>().par_reduce(std::int64_t{}, [](const foo<0>& f) { return f.a; }, std::plus{});
+
+    REQUIRE(sum == std::int64_t{ 10000 } * 9999 / 2);
+}
+
+TEST_CASE("Deterministic schedule") {
+    auto run = [](std::size_t workers) {
+        thread_pool pool{ workers };
+        registry reg;
+
+        float total{};
+        auto exec = schedule()
+                        .deterministic()
+                        .begin_stage()
+                        .add_system([](command_writer cmd) {
+                            for (int i = 0; i < 100; i++) {
+                                cmd.create<foo<0>>({ i, 0 });
+                            }
+                        })
+                        .add_system([](command_writer cmd) {
+                            for (int i = 0; i < 100; i++) {
+                                cmd.create<foo<0>>({ -i, 1 });
+                            }
+                        })
+                        .end_stage()
+                        .begin_stage()
+                        .add_system([](view<foo<0>&> v) { v.par_each([](foo<0>& f) { f.a = f.a * 3 + f.b; }); })
+                        .end_stage()
+                        .begin_stage()
+                        .add_system([&total](view<const foo<0>&> v) {
+                            total += v.par_reduce(
+                                0.0f, [](const foo<0>& f) { return 1.0f / static_cast<float>(f.a + 1000); },
+                                std::plus{});
+                        })
+                        .end_stage()
+                        .create_executor(reg);
+
+        std::vector<int> values;
+        for (int frame = 0; frame < 3; frame++) {
+            exec->run_once();
+            values.clear();
+            reg.each([&values](const foo<0>& f) {
+                values.push_back(f.a);
+                values.push_back(f.b);
+            });
+        }
+        return std::make_pair(values, total);
+    };
+
+    auto expected = run(1);
+    REQUIRE(expected.first.size() == 1200);
+    for (std::size_t workers = 2; workers <= 4; workers++) {
+        REQUIRE(run(workers) == expected);
+    }
+}
+
+TEST_CASE("Schedule auto tuning") {
+    struct stage_logger : profiler {
+        void report_stage(const stage_report& report) override {
+            reports.push_back(report);
+        }
+        std::vector<stage_report> reports;
+    };
+
+    thread_pool pool{ 4 };
+    registry reg;
+    stage_logger logger;
+    profiler::set(&logger);
+
+    // long systems keep a worker busy for a while, only the order of conflicting systems is checked, not timings
+    auto busy = []() {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds{ 200 };
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    };
+    std::atomic<int> sequence{};
+    std::array<int, 4> finished{};
+    std::array<std::atomic<int>, 4> runs{};
+    auto exec = schedule()
+                    .auto_tune(3)
+                    .begin_stage("update")
+                    .add_system([&](view<foo<0>&>) {
+                        finished[0] = sequence++;
+                        runs[0]++;
+                    })
+                    .add_system([&](view<foo<0>&>) {
+                        busy();
+                        finished[1] = sequence++;
+                        runs[1]++;
+                    })
+                    .add_system([&](view<foo<1>&>) {
+                        busy();
+                        finished[2] = sequence++;
+                        runs[2]++;
+                    })
+                    .add_system([&](view<foo<1>&>) {
+                        finished[3] = sequence++;
+                        runs[3]++;
+                    })
+                    .end_stage()
+                    .create_executor(reg);
+
+    // conflicting systems run in insertion order before and after retunes
+    for (int frame = 0; frame < 6; frame++) {
+        exec->run_once();
+        REQUIRE(finished[0] < finished[1]);
+        REQUIRE(finished[2] < finished[3]);
+    }
+    profiler::set(nullptr);
+
+    for (const auto& count : runs) {
+        REQUIRE(count == 6);
+    }
+
+    REQUIRE(logger.reports.size() == 2);
+    const auto& first = logger.reports.front();
+    REQUIRE(first.name == "update");
+    REQUIRE(first.retunes == 1);
+
+    auto reports = exec->reports();
+    REQUIRE(reports.size() == 1);
+    REQUIRE(reports[0].retunes == 2);
+    REQUIRE(reports[0].tuned <= reports[0].predicted);
+}
+
+TEST_CASE("Schedule auto tuning placement") {
+    using batches_t = std::vector<std::vector<std::size_t>>;
+    using namespace std::chrono_literals;
+
+    access_pattern_t writes_foo_0(access_type::write, component_meta::of<foo<0>>());
+    access_pattern_t writes_foo_1(access_type::write, component_meta::of<foo<1>>());
+
+    SECTION("Conflicting writers keep their order") {
+        // plain longest processing time first would run the second writer first
+        auto batches = detail::tune_batches({ { 0 }, { 1 } }, { writes_foo_0, writes_foo_0 }, { 1us, 1ms });
+        REQUIRE(batches == batches_t{ { 0 }, { 1 } });
+    }
+
+    SECTION("Long systems share a batch") {
+        // insertion order pairs each long system with a short one
+        auto batches = detail::tune_batches({ { 0, 2 }, { 1, 3 } },
+            { writes_foo_0, writes_foo_0, writes_foo_1, writes_foo_1 },
+            { 1us, 1ms, 1ms, 1us });
+        REQUIRE(batches == batches_t{ { 0 }, { 1, 2 }, { 3 } });
+    }
+
+    SECTION("Order is kept transitively") {
+        // the first and the last system do not conflict but the second one conflicts with both
+        auto reads_foo_0_writes_foo_1 = access_pattern_t(access_type::read, component_meta::of<foo<0>>());
+        reads_foo_0_writes_foo_1 &= writes_foo_1;
+        auto batches = detail::tune_batches(
+            { { 0 }, { 1 }, { 2 } }, { writes_foo_0, reads_foo_0_writes_foo_1, writes_foo_1 }, { 1ms, 1us, 1ms });
+        REQUIRE(batches == batches_t{ { 0 }, { 1 }, { 2 } });
+    }
+}
+
+TEST_CASE("Time sliced system") {
+    registry reg;
+
+    for (auto i = 0; i < 10000; i++) {
+        reg.create<foo<0>>({ 0, 0 });
+    }
+
+    std::size_t chunks_total{};
+    for (auto& [_, archetype] : reg.archetypes()) {
+        if (archetype->contains<foo<0>>()) {
+            chunks_total += archetype->chunks().size();
+        }
+    }
+    REQUIRE(chunks_total > 2);
+
+    struct budget_recorder : profiler {
+        void report_budget([[maybe_unused]] std::string_view system, const budget_usage& usage) override {
+            reports.push_back(usage);
+        }
+
+        std::vector<budget_usage> reports;
+    } recorder;
+    profiler::set(&recorder);
+
+    int passes{};
+    auto exec = schedule()
+                    .begin_stage()
+                    .add_system(system_budget{ .chunks = 2 },
+                        [&passes](sliced_view<foo<0>&>& v) {
+                            if (v.each([](foo<0>& f) { f.a++; })) {
+                                passes++;
+                            }
+                        })
+                    .end_stage()
+                    .create_executor(reg);
+
+    auto frames = (chunks_total + 1) / 2;
+    for (std::size_t frame = 0; frame < frames; frame++) {
+        exec->run_once();
+    }
+
+    profiler::set(nullptr);
+
+    REQUIRE(passes == 1);
+    reg.each([](const foo<0>& f) { REQUIRE(f.a == 1); });
+
+    REQUIRE(recorder.reports.size() == frames);
+    REQUIRE(recorder.reports.front().chunks == 2);
+    REQUIRE(recorder.reports.front().exhausted);
+    REQUIRE_FALSE(recorder.reports.back().exhausted);
+}
+
+TEST_CASE("Time sliced system survives structural changes") {
+    registry reg;
+
+    std::vector<entity> entities;
+    for (auto i = 0; i < 10000; i++) {
+        entities.push_back(reg.create<foo<0>>({ 0, 0 }));
+    }
+
+    sliced_view<foo<0>&> v{ reg };
+
+    {
+        budget_tracker tracker{ system_budget{ .chunks = 1 } };
+        REQUIRE_FALSE(v.each([](foo<0>& f) { f.a++; }));
+    }
+
+    // new archetypes and removed chunks in between runs
+    for (auto i = 0; i < 5000; i++) {
+        reg.get_entity(entities[i]).set<foo<1>>(1, 1);
+    }
+    for (auto i = 5000; i < 10000; i++) {
+        reg.destroy(entities[i]);
+    }
+
+    bool completed{};
+    for (int run = 0; run < 100 && !completed; run++) {
+        budget_tracker tracker{ system_budget{ .chunks = 1 } };
+        completed = v.each([](foo<0>& f) { f.a++; });
+    }
+    REQUIRE(completed);
+
+    // without a budget a full pass is done at once
+    REQUIRE(v.each([](foo<0>& f) { f.b++; }));
+    reg.each([](const foo<0>& f) { REQUIRE(f.b == 1); });
+}
+
+TEST_CASE("Pipelined executor") {
+    struct snapshot {
+        std::vector<foo<0>> foos;
+    };
+
+    registry reg;
+    for (auto i = 0; i < 1000; i++) {
+        reg.create<foo<0>>({ 0, 0 });
+    }
+
+    std::mutex mutex;
+    std::vector<int> consumed;
+
+    {
+        pipelined_executor<snapshot> pipeline(
+            reg,
+            schedule()
+                .begin_stage()
+                .add_system([](view<foo<0>&> v) { v.par_each([](foo<0>& f) { f.a++; }); })
+                .end_stage()
+                .create_executor(reg),
+            [](const registry& reg, snapshot& snap) { reg.view<const foo<0>&>().par_extract(snap.foos); });
+
+        // consumers run on worker threads, record results and check them on the main thread
+        pipeline.add_consumer([&](const snapshot& snap) {
+            auto frame = snap.foos.front().a;
+            auto consistent = std::ranges::all_of(snap.foos, [frame](const foo<0>& f) { return f.a == frame; });
+            std::lock_guard lock{ mutex };
+            consumed.push_back(consistent ? frame : -1);
+        });
+
+        for (auto frame = 0; frame < 10; frame++) {
+            pipeline.run_once();
+            REQUIRE(pipeline.stats().depth <= 2);
+        }
+
+        pipeline.wait();
+        REQUIRE(pipeline.stats().frames == 10);
+        REQUIRE(pipeline.stats().depth == 0);
+    }
+
+    std::ranges::sort(consumed);
+    REQUIRE(consumed == std::vector<int>{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 });
+}
+
+TEST_CASE("Pipelined executor consumers outlive task pool slots") {
+    struct snapshot {
+        int frame{};
+    };
+
+    thread_pool pool{ 2 };
+    registry reg;
+
+    std::atomic<bool> release{};
+    std::atomic<int> consumed{};
+    {
+        pipelined_executor<snapshot> pipeline(
+            reg, schedule().create_executor(reg), [](const registry&, snapshot& snap) { snap.frame++; });
+        pipeline.add_consumer([&](const snapshot&) {
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+            consumed++;
+        });
+        pipeline.run_once();
+
+        // later frames allocate more tasks on this thread than the task pool holds
+        for (std::size_t i = 0; i < task_pool::max_tasks + 1; i++) {
+            task_pool::allocate([]() {});
+        }
+
+        release = true;
+        pipeline.wait();
+    }
+    REQUIRE(consumed == 1);
+}